@@ -24,6 +24,30 @@ contains(DEFINES,TSOBJECTIVEFUNCTIONCOMPONENT_LIBRARY){
   TEMPLATE = app
   CONFIG-=app_bundle
   message("Compiling TSObjectiveFunctionComponent as application")
+
+  #The application scores stored simulation outputs and benchmarks the component against a synthetic provider
+  HEADERS += ./include/batchevaluator.h \
+             ./include/syntheticdata.h \
+             ./include/syntheticprovider.h \
+             ./include/objectivebenchmark.h
+
+  SOURCES += ./src/main.cpp \
+             ./src/batchevaluator.cpp \
+             ./src/syntheticdata.cpp \
+             ./src/syntheticprovider.cpp \
+             ./src/objectivebenchmark.cpp
+
+  macx{
+    LIBS += -lgdal
+  }
+
+  linux{
+    LIBS += -lgdal
+  }
+
+  win32{
+    LIBS += -lpsapi
+  }
 }
 
 CONFIG += c++11
@@ -43,14 +67,32 @@ HEADERS += ./include/stdafx.h\
            ./include/tsobjectivefunctioncomponent.h \
            ./include/tsobjectivefunctioncomponentinfo.h \
            ./include/objectiveinput.h \
-           ./include/objectiveoutput.h
+           ./include/objectiveoutput.h \
+           ./include/objectivestatistics.h \
+           ./include/objectivestatisticsarray.h \
+           ./include/objectivestatisticskernel.h \
+           ./include/observationindex.h \
+           ./include/observationstore.h \
+           ./include/observationseries.h \
+           ./include/providergeometryindex.h \
+           ./include/valuearraydata.h \
+           ./include/geometrystore.h \
+           ./include/resultwriter.h
 
 
 SOURCES +=./src/stdafx.cpp \ 
           ./src/tsobjectivefunctioncomponentinfo.cpp \
           ./src/tsobjectivefunctioncomponent.cpp \
           ./src/objectiveinput.cpp \
-          ./src/objectiveoutput.cpp
+          ./src/objectiveoutput.cpp \
+          ./src/objectivestatistics.cpp \
+          ./src/objectivestatisticsarray.cpp \
+          ./src/observationindex.cpp \
+          ./src/observationstore.cpp \
+          ./src/observationseries.cpp \
+          ./src/providergeometryindex.cpp \
+          ./src/geometrystore.cpp \
+          ./src/resultwriter.cpp
 
 
 macx{
@@ -58,6 +100,9 @@ macx{
     INCLUDEPATH += /usr/local \
                    /usr/local/include
 
+    #Keep multiply-add contraction off so the scalar and SIMD statistics kernels give identical results
+    QMAKE_CXXFLAGS += -ffp-contract=off
+
     contains(DEFINES, USE_NETCDF){
     message("NetCDF enabled")
     LIBS += -L/usr/local/lib -lnetcdf-cxx4
@@ -102,6 +147,9 @@ linux{
     INCLUDEPATH += /usr/include \
                    ../gdal/include
 
+    #Keep multiply-add contraction off so the scalar and SIMD statistics kernels give identical results
+    QMAKE_CXXFLAGS += -ffp-contract=off
+
     contains(DEFINES,USE_CHPC){
 
          INCLUDEPATH += /uufs/chpc.utah.edu/sys/installdir/hdf5/1.8.17-c7/include \
@@ -0,0 +1,106 @@
+/*!
+ *  \file    batchevaluator.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef BATCHEVALUATOR_H
+#define BATCHEVALUATOR_H
+
+#include "tsobjectivefunctioncomponent.h"
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTextStream>
+#include <vector>
+
+class ObjectiveInput;
+class ObjectiveOutput;
+
+/*!
+ * \brief The BatchEvaluator class scores stored simulation outputs against the objectives of an input file
+ * without running a coupled simulation. The input file is read by a TSObjectiveFunctionComponent, so options,
+ * observations and the simulation horizon are interpreted exactly as in a coupled run.
+ *
+ * A simulation file is a delimited text time series with a header line, a julian day or date time column and
+ * one column per objective geometry, ordered as the objectives in [OBJECTIVES] and the geometries within each
+ * objective. Simulated values are linearly interpolated to the observation times, as done for providers.
+ */
+class BatchEvaluator
+{
+  public:
+
+    BatchEvaluator();
+
+    ~BatchEvaluator();
+
+    /*!
+     * \brief initialize reads the objectives of an input file.
+     * \param inputFile
+     * \param error
+     * \return False if the component could not be initialized from the input file.
+     */
+    bool initialize(const QString &inputFile, QString &error);
+
+    /*!
+     * \brief columnCount
+     * \return Number of simulated value columns expected in each simulation file.
+     */
+    int columnCount() const;
+
+    /*!
+     * \brief evaluate scores simulation files in parallel and writes one result row per file in the order given.
+     * Files that cannot be scored are skipped and reported in error.
+     * \param simulationFiles
+     * \param results
+     * \param error
+     * \return False if any file could not be scored.
+     */
+    bool evaluate(const QStringList &simulationFiles, QTextStream &results, QString &error) const;
+
+    /*!
+     * \brief evaluateRun streams a simulation file once and evaluates all objectives. Safe to call concurrently.
+     * \param simulationFile
+     * \param values Receives the objective values in the order of the component's output CSV file.
+     * \param error
+     * \return False if the file could not be read.
+     */
+    bool evaluateRun(const QString &simulationFile, std::vector<double> &values, QString &error) const;
+
+  private:
+
+    struct Objective
+    {
+      ObjectiveInput *input;
+      QSharedPointer<const std::vector<int>> alignedRows;
+      int columnOffset;
+    };
+
+    void finish();
+
+    void writeHeader(QTextStream &results) const;
+
+  private:
+
+    TSObjectiveFunctionComponentInfo *m_componentInfo;
+    TSObjectiveFunctionComponent *m_component;
+    std::vector<Objective> m_objectives;
+    std::vector<ObjectiveOutput*> m_outputs;
+    std::vector<int> m_outputObjectives;
+    int m_columnCount;
+};
+
+#endif // BATCHEVALUATOR_H
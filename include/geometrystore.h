@@ -0,0 +1,83 @@
+/*!
+ *  \file    geometrystore.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef GEOMETRYSTORE_H
+#define GEOMETRYSTORE_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+#include "spatial/geometry.h"
+
+#include <QFileInfo>
+#include <QList>
+#include <QSharedPointer>
+
+/*!
+ * \brief The GeometrySet class is a read-only set of geometries loaded from a shapefile or WKT string.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT GeometrySet
+{
+  public:
+
+    GeometrySet(const QList<HCGeometry*> &geometries);
+
+    const QList<QSharedPointer<HCGeometry>> &geometries() const;
+
+  private:
+
+    Q_DISABLE_COPY(GeometrySet)
+
+  private:
+
+    QList<QSharedPointer<HCGeometry>> m_geometries;
+};
+
+/*!
+ * \brief The GeometryStore class is a process wide cache of the geometry sets listed under
+ * [OBJECTIVE_GEOMETRIES]. Shapefiles are keyed by absolute file path and modification time and WKT
+ * strings by a hash of their text. Sets are reference counted, so components and their clones that
+ * read the same source share one copy and only the first load goes through GDAL.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT GeometryStore
+{
+  public:
+
+    /*!
+     * \brief shapefileGeometries returns the shared geometries of a shapefile, reading it only if no component holds it.
+     * \param file
+     * \param error
+     * \return Null if the file could not be read.
+     */
+    static QSharedPointer<GeometrySet> shapefileGeometries(const QFileInfo &file, QString &error);
+
+    /*!
+     * \brief wktGeometries returns the shared geometry of a WKT string, parsing it only if no component holds it.
+     * \param wkt
+     * \param error
+     * \return Null if the string could not be parsed.
+     */
+    static QSharedPointer<GeometrySet> wktGeometries(const QString &wkt, QString &error);
+
+    /*!
+     * \brief count
+     * \return Number of geometry sets currently held by at least one component.
+     */
+    static int count();
+};
+
+#endif // GEOMETRYSTORE_H
@@ -0,0 +1,129 @@
+/*!
+ *  \file    objectivebenchmark.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBJECTIVEBENCHMARK_H
+#define OBJECTIVEBENCHMARK_H
+
+#include "syntheticdata.h"
+
+#include <QObject>
+#include <QTextStream>
+
+class QTemporaryDir;
+class ObjectiveInput;
+class TSObjectiveFunctionComponent;
+class TSObjectiveFunctionComponentInfo;
+class SyntheticProviderComponent;
+class SyntheticProviderComponentInfo;
+
+/*!
+ * \brief The ObjectiveBenchmark class benchmarks the TSObjectiveFunctionComponent on a synthetic problem
+ * coupled to a SyntheticProviderComponent. runComponent times a complete initialize/prepare/update/finish
+ * run, and the private slots are QBENCHMARK micro-benchmarks and checks executed through QTest::qExec. The MPI
+ * checks are skipped unless the application is started with mpirun, e.g.,
+ * mpirun -n 4 TSObjectiveFunctionComponent --benchmark --micro -- allReduce ensembleOutput
+ */
+class ObjectiveBenchmark : public QObject
+{
+    Q_OBJECT
+
+  public:
+
+    ObjectiveBenchmark(const SyntheticDataOptions &options, QObject *parent = nullptr);
+
+    virtual ~ObjectiveBenchmark();
+
+    /*!
+     * \brief runComponent runs the component through a complete simulation and reports per phase timings,
+     * peak resident set size and throughput.
+     * \param report
+     * \param error
+     * \return False if the synthetic problem could not be generated or the components failed.
+     */
+    bool runComponent(QTextStream &report, QString &error);
+
+    /*!
+     * \brief peakResidentSetSize
+     * \return Peak resident set size of the process in bytes or -1 if it is not available.
+     */
+    static qint64 peakResidentSetSize();
+
+  private slots:
+
+    void initTestCase();
+
+    void cleanupTestCase();
+
+    void applyData();
+
+    void setProvider();
+
+    void providerGeometryIndex();
+
+    void statisticsKernel_data();
+
+    void statisticsKernel();
+
+    void metrics_data();
+
+    void metrics();
+
+    /*!
+     * \brief allReduce checks that statistics reduced across MPI ranks match statistics accumulated on one rank.
+     */
+    void allReduce();
+
+    /*!
+     * \brief ensembleOutput checks that rank 0 writes the rows of every ensemble member when ranks run different
+     * numbers of members.
+     */
+    void ensembleOutput();
+
+    /*!
+     * \brief metricLowerBound checks that the lower bounds used by PRUNE_THRESHOLD never exceed the metrics at the
+     * end of the simulation horizon.
+     */
+    void metricLowerBound();
+
+  private:
+
+    bool generate(QString &error);
+
+    bool initialize(QString &error);
+
+    void link();
+
+    bool prepare(QString &error);
+
+    void finish();
+
+    ObjectiveInput *objectiveInput() const;
+
+  private:
+
+    SyntheticDataOptions m_options;
+    QTemporaryDir *m_directory;
+    QString m_inputFile, m_geometryFile;
+    TSObjectiveFunctionComponentInfo *m_componentInfo;
+    SyntheticProviderComponentInfo *m_providerInfo;
+    TSObjectiveFunctionComponent *m_component;
+    SyntheticProviderComponent *m_provider;
+};
+
+#endif // OBJECTIVEBENCHMARK_H
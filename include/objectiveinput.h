@@ -4,12 +4,19 @@
 #include "tsobjectivefunctioncomponent_global.h"
 #include "spatiotemporal/timegeometryinput.h"
 #include "tsobjectivefunctioncomponent.h"
+#include "objectivestatisticsarray.h"
 
-#include <unordered_map>
+#include <vector>
 
-class TimeSeries;
+class ObservationSeries;
+class ITimeGeometryValueArray;
 class Quantity;
 
+namespace SDKTemporal
+{
+  class DateTime;
+}
+
 /*!
  * \brief The ObjectiveInput class
  * \todo Can currently only account of linestrings
@@ -18,10 +25,12 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveInput : public TimeGeometryIn
 {
     Q_OBJECT
 
+    friend class ObjectiveBenchmark;
+
   public:
 
     ObjectiveInput(const QString &id,
-                   TimeSeries *timeSeries,
+                   ObservationSeries *timeSeries,
                    Dimension *timeDimension,
                    Dimension *geometryDimension,
                    HydroCouple::Spatial::IGeometry::GeometryType geometryType,
@@ -32,34 +41,175 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveInput : public TimeGeometryIn
 
     void initialize();
 
+    /*!
+     * \brief reset rewinds the input to the first observation time of the simulation horizon and clears
+     * the running statistics. Observations, aligned rows and the provider mapping are kept.
+     */
+    void reset();
+
     int startDateTimeIndex() const;
 
+    /*!
+     * \brief recordLength
+     * \return Number of observation records aligned with the simulation horizon.
+     */
     int recordLength() const;
 
     double currentDateTime() const;
 
     void moveToNextDateTime();
 
+    /*!
+     * \brief timeTolerance
+     * \return Tolerance in days used to match observation times against the simulation horizon and provider times.
+     */
+    double timeTolerance() const;
+
+    void setTimeTolerance(double timeTolerance);
+
+    /*!
+     * \brief retainHistory
+     * \return True if a time slot is added for every observation time. Otherwise only the
+     * latest slot is kept and reused so memory stays proportional to the geometry count.
+     */
+    bool retainHistory() const;
+
+    void setRetainHistory(bool retainHistory);
+
+    /*!
+     * \brief accumulateLogarithmicStatistics
+     * \return True if log-transformed statistics are accumulated, i.e., when one of the objective
+     * algorithms requires them.
+     */
+    bool accumulateLogarithmicStatistics() const;
+
+    void setAccumulateLogarithmicStatistics(bool accumulate);
+
     bool setProvider(HydroCouple::IOutput *provider) override;
 
     bool canConsume(HydroCouple::IOutput *provider, QString &message) const override;
 
     void retrieveValuesFromProvider() override;
 
+    /*!
+     * \brief prepareRetrieval sets up the time slot for the current observation time without pulling values
+     * from the provider. Used when another input has already pulled the same provider up to this time.
+     * \return True if the provider can still be updated.
+     */
+    bool prepareRetrieval();
+
     void applyData() override;
 
-    TimeSeries *timeSeries() const;
+    /*!
+     * \brief batchUpdate
+     * \return True if applyData consumes every observation time that falls within the provider's
+     * available times instead of only the current one.
+     */
+    bool batchUpdate() const;
+
+    void setBatchUpdate(bool batchUpdate);
+
+    ObservationSeries *timeSeries() const;
+
+    /*!
+     * \brief timeSeriesKey
+     * \return Key identifying the contents of the observation series. Inputs with the same key
+     * share the observation records aligned with the simulation horizon.
+     */
+    QString timeSeriesKey() const;
+
+    void setTimeSeriesKey(const QString &timeSeriesKey);
+
+    /*!
+     * \brief statistics returns the running observed/simulated statistics for a geometry.
+     * \param geometryIndex
+     * \return
+     */
+    ObjectiveStatistics statistics(int geometryIndex) const;
+
+    /*!
+     * \brief metrics evaluates an objective function for all geometries from the running statistics.
+     * \param algorithm
+     * \param values Contiguous array receiving geometryCount() metric values.
+     */
+    void metrics(TSObjectiveFunctionComponent::Algorithm algorithm, double *values) const;
+
+    /*!
+     * \brief initializeMetricBounds computes the sum of squared deviations of the observations of every geometry
+     * over the simulation horizon, which bounds the Nash-Sutcliffe efficiency before the horizon is reached.
+     */
+    void initializeMetricBounds();
+
+    /*!
+     * \brief metricLowerBound returns a lower bound of the mean metric of all geometries at the end of the
+     * simulation horizon. Error sums only grow as pairs are accumulated, so dividing the sums accumulated so far
+     * by the number of pairs and observed deviations of the complete horizon never overestimates the final metric.
+     * \param algorithm NashSutcliff, RMSE or MAE. NashSutcliff requires initializeMetricBounds. MAE is bounded by
+     * sqrt(sum|o - s| / n) like the MAE metric.
+     * \return Zero for algorithms without a bound.
+     */
+    double metricLowerBound(TSObjectiveFunctionComponent::Algorithm algorithm) const;
+
+    /*!
+     * \brief statisticsKernel
+     * \return The kernel used to accumulate the running statistics of all geometries.
+     */
+    ObjectiveStatisticsArray::Kernel statisticsKernel() const;
+
+    /*!
+     * \brief reduceStatistics merges the statistics of this input across all MPI ranks of a decomposed domain.
+     * Geometries without a matching provider geometry on this rank are owned by other ranks and do not contribute.
+     * This is a collective call.
+     * \return False if the statistics could not be reduced.
+     */
+    bool reduceStatistics();
+
+    void setStatisticsKernel(ObjectiveStatisticsArray::Kernel kernel);
 
   private:
 
-    static bool equalsGeometry(HydroCouple::Spatial::IGeometry *geom1, HydroCouple::Spatial::IGeometry *geom2, double epsilon = 0.00001);
+    /*!
+     * \brief updateCurrentSlot adds a time slot for the current observation time or reuses the existing slot
+     * when the history is not retained.
+     */
+    void updateCurrentSlot();
+
+    /*!
+     * \brief applyProviderValues interpolates the provider values to the current observation time.
+     */
+    void applyProviderValues();
+
+    /*!
+     * \brief readProviderValues reads the provider values of all mapped geometries at a provider time. Providers
+     * that implement ITimeGeometryValueArray are read with a single copy or gather.
+     * \param timeIndex
+     * \param values Receives one value per mapped geometry in the order of the mapping.
+     */
+    void readProviderValues(int timeIndex, double *values) const;
+
+    /*!
+     * \brief accumulateStatistics adds the current observed/simulated pairs to the running statistics.
+     */
+    void accumulateStatistics();
 
   private:
 
+    bool m_retainHistory, m_accumulateLogarithmicStatistics, m_batchUpdate;
     double m_currentDateTime;
-    int m_startDateTimeIndex, m_endDateTimeIndex, m_nextDateTimeIndex;
-    std::unordered_map<int,int> m_geometryMapping;
-    TimeSeries *m_timeSeries;
+    SDKTemporal::DateTime *m_currentSlotDateTime;
+    double m_timeTolerance;
+    int m_startDateTimeIndex, m_endDateTimeIndex, m_nextDateTimeIndex, m_accumulatedDateTimeIndex, m_currentAlignedIndex;
+    QSharedPointer<const std::vector<int>> m_alignedDateTimeIndexes;
+    QString m_timeSeriesKey;
+    ITimeGeometryComponentDataItem *m_timeGeometryProvider;
+    ITimeGeometryValueArray *m_valueArrayProvider;
+    std::vector<int> m_mappedGeometries, m_mappedProviderGeometries, m_unmappedGeometries;
+    int m_contiguousProviderOffset;
+    std::vector<double> m_providerCurrentValues, m_providerPreviousValues;
+    ObjectiveStatisticsArray m_statistics;
+    std::vector<double> m_observedValues, m_simulatedValues;
+    std::vector<double> m_horizonObservedDeviations;
+    ObservationSeries *m_timeSeries;
     TSObjectiveFunctionComponent *m_objectiveFunctionComponent;
 };
 
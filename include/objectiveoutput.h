@@ -5,8 +5,12 @@
 #include "tsobjectivefunctioncomponent.h"
 #include "spatial/geometryexchangeitems.h"
 #include "objectiveinput.h"
+#include "valuearraydata.h"
 
-class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveOutput : public GeometryOutputDouble
+#include <vector>
+
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveOutput : public GeometryOutputDouble,
+    public virtual IGeometryValueArray
 {
     Q_OBJECT
 
@@ -23,11 +27,48 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveOutput : public GeometryOutpu
 
     void updateValues() override;
 
+    TSObjectiveFunctionComponent::Algorithm algorithm() const;
+
+    ObjectiveInput *objectiveInput() const;
+
+    /*!
+     * \brief evaluate computes the objective function values of all geometries from the statistics accumulated
+     * by the input. Values are only evaluated once after the input has reached the end of the simulation horizon.
+     * Geometries are evaluated in parallel when the output has at least ObjectiveStatisticsArray::parallelThreshold() of them.
+     */
+    void evaluate();
+
+    /*!
+     * \brief evaluateRunning computes the objective function values of all geometries from the statistics
+     * accumulated so far without marking the output as evaluated, so the final values are still computed
+     * at the end of the simulation horizon.
+     */
+    void evaluateRunning();
+
+    /*!
+     * \brief prune marks the values of all geometries as undefined for a run that was stopped early.
+     */
+    void prune();
+
+    /*!
+     * \brief reset clears the objective function values so that they are evaluated again.
+     */
+    void reset();
+
+    /*!
+     * \brief geometryValues
+     * \return The objective function values of all geometries once the simulation horizon has been reached,
+     * or the running values published during the simulation.
+     */
+    const double *geometryValues() const override;
+
   private:
 
     ObjectiveInput *m_objectiveInput;
     TSObjectiveFunctionComponent::Algorithm m_algorithm;
     TSObjectiveFunctionComponent *m_objectiveFunctionComponent;
+    std::vector<double> m_metrics;
+    bool m_evaluated;
 };
 
 
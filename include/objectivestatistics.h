@@ -0,0 +1,115 @@
+/*!
+ *  \file    objectivestatistics.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBJECTIVESTATISTICS_H
+#define OBJECTIVESTATISTICS_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+#include "tsobjectivefunctioncomponent.h"
+
+/*!
+ * \brief The ObjectiveStatistics class holds the running sufficient statistics of
+ * an observed/simulated pair series for a single geometry. Means and (co)variances are
+ * updated with Welford's algorithm and error sums use compensated (Kahan) summation so
+ * that the objective can be evaluated at any time in O(1) without the value history.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveStatistics
+{
+    friend class ObjectiveStatisticsArray;
+
+  public:
+
+    ObjectiveStatistics();
+
+    /*!
+     * \brief reset clears all accumulated values.
+     */
+    void reset();
+
+    /*!
+     * \brief add accumulates an observed/simulated pair.
+     * \param observed
+     * \param simulated
+     */
+    void add(double observed, double simulated);
+
+    /*!
+     * \brief addLogarithmic accumulates the log-transformed pair used by the logarithmic
+     * Nash-Sutcliffe efficiency. Pairs with non-positive values are skipped.
+     * \param observed
+     * \param simulated
+     */
+    void addLogarithmic(double observed, double simulated);
+
+    /*!
+     * \brief merge combines the statistics of another, disjoint set of pairs into these statistics
+     * using the pairwise update of Chan et al. for means and (co)variances.
+     * \param statistics
+     */
+    void merge(const ObjectiveStatistics &statistics);
+
+    /*!
+     * \brief count
+     * \return Number of pairs accumulated.
+     */
+    double count() const;
+
+    double observedMean() const;
+
+    double simulatedMean() const;
+
+    /*!
+     * \brief observedSumSquaredDeviations
+     * \return Sum of squared deviations of the observed values from their mean.
+     */
+    double observedSumSquaredDeviations() const;
+
+    double simulatedSumSquaredDeviations() const;
+
+    double sumCrossDeviations() const;
+
+    double sumSquaredErrors() const;
+
+    double sumAbsoluteErrors() const;
+
+    double logarithmicCount() const;
+
+    /*!
+     * \brief metric evaluates the objective function from the accumulated statistics.
+     * \param algorithm
+     * \return Metric value or std::numeric_limits<double>::max() if the metric is undefined.
+     */
+    double metric(TSObjectiveFunctionComponent::Algorithm algorithm) const;
+
+  private:
+
+    static void compensatedAdd(double &sum, double &compensation, double value);
+
+  private:
+
+    double m_count,
+    m_observedMean, m_simulatedMean,
+    m_observedM2, m_simulatedM2, m_crossM2,
+    m_sumSquaredErrors, m_sumSquaredErrorsComp,
+    m_sumAbsoluteErrors, m_sumAbsoluteErrorsComp,
+    m_logCount, m_logObservedMean, m_logObservedM2,
+    m_logSumSquaredErrors, m_logSumSquaredErrorsComp;
+};
+
+#endif // OBJECTIVESTATISTICS_H
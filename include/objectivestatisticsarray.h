@@ -0,0 +1,154 @@
+/*!
+ *  \file    objectivestatisticsarray.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBJECTIVESTATISTICSARRAY_H
+#define OBJECTIVESTATISTICSARRAY_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+#include "objectivestatistics.h"
+#include "objectivestatisticskernel.h"
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+/*!
+ * \brief The ObjectiveStatisticsArray class stores the running statistics of many geometries
+ * as a structure of aligned, contiguous arrays so that a time step can be accumulated for all
+ * geometries at once using SIMD kernels. Geometries are independent lanes, so the scalar, AVX2 and
+ * AVX-512 kernels perform the same operations in the same order and produce bitwise identical results.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObjectiveStatisticsArray : public ObjectiveStatisticsKernel
+{
+  public:
+
+    ObjectiveStatisticsArray();
+
+    ~ObjectiveStatisticsArray();
+
+    int size() const;
+
+    /*!
+     * \brief resize reallocates the arrays for the specified number of geometries and resets them.
+     * \param size
+     */
+    void resize(int size);
+
+    void reset();
+
+    /*!
+     * \brief kernel
+     * \return The requested kernel. Automatic selects the widest kernel supported by the processor.
+     */
+    Kernel kernel() const;
+
+    void setKernel(Kernel kernel);
+
+    /*!
+     * \brief activeKernel
+     * \return The kernel used by add after resolving Automatic and unsupported instruction sets.
+     */
+    Kernel activeKernel() const;
+
+    /*!
+     * \brief add accumulates one observed/simulated pair for every geometry.
+     * \param observed Contiguous array of size() observed values.
+     * \param simulated Contiguous array of size() simulated values.
+     */
+    void add(const double *observed, const double *simulated);
+
+    void addLogarithmic(const double *observed, const double *simulated);
+
+    /*!
+     * \brief statistics
+     * \param index
+     * \return Statistics of the geometry at index.
+     */
+    ObjectiveStatistics statistics(int index) const;
+
+    void setStatistics(int index, const ObjectiveStatistics &statistics);
+
+    /*!
+     * \brief clear resets the statistics of a single geometry.
+     * \param index
+     */
+    void clear(int index);
+
+    /*!
+     * \brief allReduce merges the statistics of every geometry across all MPI ranks with MPI_Allreduce so that each
+     * rank holds the statistics of the union of the pairs accumulated by all ranks. Ranks are merged in rank order,
+     * so all ranks obtain bitwise identical statistics. This is a collective call.
+     * \return False if MPI is not available or initialized, or the ranks hold different numbers of geometries.
+     * The statistics are left unchanged in that case. A single rank already holds the complete statistics.
+     */
+    bool allReduce();
+
+    /*!
+     * \brief metrics evaluates an objective function for every geometry.
+     * \param algorithm
+     * \param values Contiguous array receiving size() metric values.
+     */
+    void metrics(TSObjectiveFunctionComponent::Algorithm algorithm, double *values) const;
+
+    static bool isKernelSupported(Kernel kernel);
+
+    /*!
+     * \brief parallelThreshold
+     * \return Minimum number of geometries for which per geometry loops are run with OpenMP.
+     */
+    static int parallelThreshold();
+
+    static bool tryParseKernel(const QString &name, Kernel &kernel);
+
+  private:
+
+    Q_DISABLE_COPY(ObjectiveStatisticsArray)
+
+    void allocate(int size);
+
+    void deallocate();
+
+    static ObjectiveStatistics statistics(const double *data, int stride, int index);
+
+    static void setStatistics(double *data, int stride, int index, const ObjectiveStatistics &statistics);
+
+#ifdef USE_MPI
+    /*!
+     * \brief mergeReduction is the MPI reduction operation of allReduce. Each element is a complete array of
+     * statistics laid out as in allocate.
+     */
+    static void mergeReduction(void *invec, void *inoutvec, int *len, MPI_Datatype *datatype);
+#endif
+
+  private:
+
+    static const int m_parallelThreshold;
+    int m_size, m_stride;
+    Kernel m_kernel;
+    double *m_data;
+    double *m_count,
+    *m_observedMean, *m_simulatedMean,
+    *m_observedM2, *m_simulatedM2, *m_crossM2,
+    *m_sumSquaredErrors, *m_sumSquaredErrorsComp,
+    *m_sumAbsoluteErrors, *m_sumAbsoluteErrorsComp,
+    *m_logCount, *m_logObservedMean, *m_logObservedM2,
+    *m_logSumSquaredErrors, *m_logSumSquaredErrorsComp;
+};
+
+#endif // OBJECTIVESTATISTICSARRAY_H
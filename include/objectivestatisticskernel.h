@@ -0,0 +1,40 @@
+/*!
+ *  \file    objectivestatisticskernel.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBJECTIVESTATISTICSKERNEL_H
+#define OBJECTIVESTATISTICSKERNEL_H
+
+/*!
+ * \brief The ObjectiveStatisticsKernel struct declares the kernels used to accumulate objective statistics.
+ * ObjectiveStatisticsArray inherits it, so the kernels are referred to as ObjectiveStatisticsArray::Kernel.
+ * It has no dependencies so that TSObjectiveFunctionComponent can store a kernel without including
+ * objectivestatisticsarray.h, which itself depends on tsobjectivefunctioncomponent.h.
+ */
+struct ObjectiveStatisticsKernel
+{
+    enum Kernel
+    {
+      Automatic,
+      Scalar,
+      AVX2,
+      AVX512,
+    };
+};
+
+#endif // OBJECTIVESTATISTICSKERNEL_H
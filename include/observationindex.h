@@ -0,0 +1,84 @@
+/*!
+ *  \file    observationindex.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBSERVATIONINDEX_H
+#define OBSERVATIONINDEX_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+
+#include <QString>
+#include <QSharedPointer>
+#include <vector>
+
+class ObservationSeries;
+
+/*!
+ * \brief The ObservationIndex class locates observation records that fall within a simulation horizon.
+ * Results are cached process wide per observation series key (file path and modification time) and
+ * horizon so that clones of a component initialize without scanning their observations again.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObservationIndex
+{
+  public:
+
+    /*!
+     * \brief seriesKey
+     * \param filePath Absolute path of the observation file.
+     * \param lastModified Modification time of the file in milliseconds since epoch.
+     * \return Key identifying the contents of an observation series.
+     */
+    static QString seriesKey(const QString &filePath, qint64 lastModified);
+
+    /*!
+     * \brief isMonotonic checks whether the series times are non-decreasing. The check is performed
+     * once per series key.
+     * \param seriesKey
+     * \param timeSeries
+     * \return
+     */
+    static bool isMonotonic(const QString &seriesKey, ObservationSeries *timeSeries);
+
+    /*!
+     * \brief lowerBound
+     * \param timeSeries Series with non-decreasing times.
+     * \param dateTime
+     * \return First row with a time greater than or equal to dateTime or the number of rows if none.
+     */
+    static int lowerBound(ObservationSeries *timeSeries, double dateTime);
+
+    /*!
+     * \brief alignedRows returns the rows of the series within [startTime - tolerance, endTime + tolerance],
+     * skipping rows within tolerance of the previously accepted row.
+     * \param seriesKey Key of the series. Results are not cached when empty.
+     * \param timeSeries
+     * \param startTime
+     * \param endTime
+     * \param tolerance
+     * \return
+     */
+    static QSharedPointer<const std::vector<int>> alignedRows(const QString &seriesKey, ObservationSeries *timeSeries,
+                                                              double startTime, double endTime, double tolerance);
+
+  private:
+
+    static QSharedPointer<const std::vector<int>> createAlignedRows(ObservationSeries *timeSeries, bool monotonic,
+                                                                    double startTime, double endTime, double tolerance);
+};
+
+#endif // OBSERVATIONINDEX_H
@@ -0,0 +1,134 @@
+/*!
+ *  \file    observationseries.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBSERVATIONSERIES_H
+#define OBSERVATIONSERIES_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+class TimeSeries;
+
+/*!
+ * \brief The ObservationSeries class is a read-only observation table with a julian day column and a
+ * row-major value matrix (one column per geometry). The arrays are either owned in memory or memory mapped
+ * from a binary sidecar file written next to the text observation file.
+ *
+ * Sidecar layout (little-endian): 64 byte header {char magic[8]; uint32 version; uint32 headerSize;
+ * int64 sourceModified; int64 sourceSize; int64 numRows; int64 numColumns; uint64 payloadChecksum;
+ * uint64 headerChecksum}, followed by numRows julian days and numRows x numColumns values.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObservationSeries
+{
+  public:
+
+    /*!
+     * \brief ObservationSeries copies the values of a parsed text time series.
+     * \param timeSeries
+     */
+    ObservationSeries(TimeSeries *timeSeries);
+
+    ~ObservationSeries();
+
+    int numRows() const
+    {
+      return m_numRows;
+    }
+
+    int numColumns() const
+    {
+      return m_numColumns;
+    }
+
+    double dateTime(int row) const
+    {
+      return m_dateTimes[row];
+    }
+
+    double value(int row, int column) const
+    {
+      return m_values[static_cast<size_t>(row) * m_numColumns + column];
+    }
+
+    /*!
+     * \brief row
+     * \param row
+     * \return Pointer to the numColumns() contiguous values of a row.
+     */
+    const double *row(int row) const
+    {
+      return m_values + static_cast<size_t>(row) * m_numColumns;
+    }
+
+    /*!
+     * \brief isMapped
+     * \return True if the arrays are memory mapped from a sidecar file.
+     */
+    bool isMapped() const;
+
+    /*!
+     * \brief sidecarFilePath
+     * \param filePath Observation text file.
+     * \return Path of the binary sidecar file of the observation file.
+     */
+    static QString sidecarFilePath(const QString &filePath);
+
+    /*!
+     * \brief map memory maps the sidecar of an observation file if it exists, is valid and matches the source file.
+     * The sidecar is validated with its header only: magic, version, header checksum, the modification time and
+     * size of the source file, and the row and column counts against the file size. This keeps opening O(1) and
+     * leaves the pages untouched until they are read.
+     * \param filePath Observation text file.
+     * \param verifyPayload Also checks the checksum of the mapped arrays, which reads the whole file. ObservationStore
+     * verifies it the first time a process maps a version of a sidecar.
+     * \return Null if the sidecar could not be used.
+     */
+    static ObservationSeries *map(const QString &filePath, bool verifyPayload = false);
+
+    /*!
+     * \brief writeSidecar writes the binary sidecar of an observation file. The file is written to a
+     * temporary file first and renamed so that concurrent readers never map a partial file.
+     * \param filePath Observation text file.
+     * \return
+     */
+    bool writeSidecar(const QString &filePath) const;
+
+  private:
+
+    ObservationSeries();
+
+    Q_DISABLE_COPY(ObservationSeries)
+
+    static quint64 checksum(const uchar *data, qint64 size, quint64 hash = 14695981039346656037ULL);
+
+  private:
+
+    int m_numRows, m_numColumns;
+    const double *m_dateTimes, *m_values;
+    std::vector<double> m_ownedDateTimes, m_ownedValues;
+    QFile m_mappedFile;
+    uchar *m_mappedData;
+    static const char m_magic[8];
+    static const quint32 m_version;
+};
+
+#endif // OBSERVATIONSERIES_H
@@ -0,0 +1,57 @@
+/*!
+ *  \file    observationstore.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef OBSERVATIONSTORE_H
+#define OBSERVATIONSTORE_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+
+#include <QFileInfo>
+#include <QSharedPointer>
+
+class ObservationSeries;
+
+/*!
+ * \brief The ObservationStore class is a process wide cache of read-only observation time series.
+ * Series are keyed by absolute file path and modification time and are reference counted, so
+ * components and their clones that read the same file share a single copy of the observations.
+ * A series is released when the last component referencing it lets go of it.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ObservationStore
+{
+  public:
+
+    /*!
+     * \brief timeSeries returns the shared series for a file, reading it only if no component holds it.
+     * \param file Observation time series file.
+     * \param seriesKey Key identifying the contents of the series.
+     * \param binaryCache Memory maps the binary sidecar of the file if it is up to date, otherwise
+     * parses the text file and writes the sidecar for subsequent runs.
+     * \return Null if the file could not be read.
+     */
+    static QSharedPointer<ObservationSeries> timeSeries(const QFileInfo &file, QString &seriesKey, bool binaryCache = true);
+
+    /*!
+     * \brief count
+     * \return Number of series currently held by at least one component.
+     */
+    static int count();
+};
+
+#endif // OBSERVATIONSTORE_H
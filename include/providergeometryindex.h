@@ -0,0 +1,104 @@
+/*!
+ *  \file    providergeometryindex.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef PROVIDERGEOMETRYINDEX_H
+#define PROVIDERGEOMETRYINDEX_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+
+#include <QtGlobal>
+#include <vector>
+
+namespace HydroCouple
+{
+  namespace Spatial
+  {
+    class IGeometry;
+  }
+
+  namespace SpatioTemporal
+  {
+    class ITimeGeometryComponentDataItem;
+  }
+}
+
+/*!
+ * \brief The ProviderGeometryIndex class matches input geometries against the geometries of a provider.
+ * Linestring vertices are hashed onto a uniform grid with a cell size equal to the matching tolerance, so a
+ * vertex only needs to be compared against provider vertices in the neighbouring cells. The index is built
+ * once per provider and shared by all inputs linked to it.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ProviderGeometryIndex
+{
+  public:
+
+    /*!
+     * \brief ProviderGeometryIndex
+     * \param provider
+     * \param epsilon Distance within which linestring vertices are considered equal.
+     */
+    ProviderGeometryIndex(HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem *provider, double epsilon = 0.00001);
+
+    ~ProviderGeometryIndex();
+
+    /*!
+     * \brief geometryCount
+     * \return Number of provider geometries at the time the index was built.
+     */
+    int geometryCount() const;
+
+    double epsilon() const;
+
+    /*!
+     * \brief findGeometry
+     * \param geometry
+     * \return Index of the first provider geometry that matches the geometry or -1 if none does. Two linestrings
+     * with the same type and vertex count match if a pair of corresponding vertices are within epsilon of each other.
+     * Other geometry types match if they are equal.
+     */
+    int findGeometry(HydroCouple::Spatial::IGeometry *geometry) const;
+
+  private:
+
+    Q_DISABLE_COPY(ProviderGeometryIndex)
+
+    struct Vertex
+    {
+      quint64 cell;
+      int geometryIndex;
+      int pointIndex;
+      double x;
+      double y;
+    };
+
+    quint64 cellKey(qint64 column, qint64 row) const;
+
+    bool cellCoordinates(double x, double y, qint64 &column, qint64 &row) const;
+
+    static bool isLineString(int geometryType);
+
+  private:
+
+    HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem *m_provider;
+    double m_epsilon;
+    std::vector<Vertex> m_vertices;
+    std::vector<int> m_geometryTypes, m_pointCounts, m_otherGeometries;
+};
+
+#endif // PROVIDERGEOMETRYINDEX_H
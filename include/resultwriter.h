@@ -0,0 +1,219 @@
+/*!
+ *  \file    resultwriter.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef USE_NETCDF
+namespace netCDF
+{
+  class NcFile;
+}
+#endif
+
+/*!
+ * \brief The ResultLayout struct describes the objective function values of a result row. Values of a row are
+ * ordered by column and by geometry within a column, as in the CSV output.
+ */
+struct TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ResultLayout
+{
+    /*!
+     * \brief The Column struct maps the values of an objective output to an objective and metric. Both are
+     * indexes into objectives and metrics.
+     */
+    struct Column
+    {
+      QString id;
+      int objective;
+      int metric;
+      int geometryCount;
+    };
+
+    QStringList objectives;
+    QStringList metrics;
+    std::vector<Column> columns;
+
+    /*!
+     * \brief valueCount
+     * \return Number of values in a row.
+     */
+    int valueCount() const;
+
+    /*!
+     * \brief geometryCount
+     * \return Largest number of geometries of an objective.
+     */
+    int geometryCount() const;
+
+    bool operator==(const ResultLayout &layout) const;
+
+    bool operator!=(const ResultLayout &layout) const;
+};
+
+/*!
+ * \brief The ResultWriter class appends objective function result rows to a file on a background thread.
+ * Writers are shared process wide per file path, so a component and all of its clones write one consolidated
+ * file with one row per run and iteration. Rows are handed over through a lock-free queue and written and
+ * flushed in batches, so the simulation threads never wait on the disk.
+ *
+ * Binary and NetCDF files store each row as an (objective, geometry, metric) block of doubles, padded with NaN
+ * where an objective has fewer geometries or a metric was not requested. Rows are appended along the iteration
+ * dimension and intermediate snapshots along a separate snapshot dimension.
+ *
+ * A binary file starts with the 8 byte magic "TSOFRES1" followed by int32 objective, geometry and metric counts,
+ * the int32 size of a record and the int32 offset of the first record. The header continues with the objective
+ * and metric names as null terminated UTF-8 strings and is padded to a multiple of 8 bytes. Each record holds a
+ * null padded 64 byte run id, an int32 iteration, an int32 kind (0 for results, 1 for snapshots), a double julian
+ * date time (NaN for results) and the values in native byte order, so the file can be memory mapped.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ResultWriter
+{
+  public:
+
+    enum Format
+    {
+      CSV,
+      Binary,
+      NetCDF,
+    };
+
+    /*!
+     * \brief open returns the writer of a file, creating the file and writing its header if no component holds it.
+     * Waits for a previous writer of the file that is still closing.
+     * \param filePath
+     * \param format
+     * \param layout
+     * \param error
+     * \return Null if the file could not be created or is already written with a different format or layout.
+     */
+    static QSharedPointer<ResultWriter> open(const QString &filePath, Format format, const ResultLayout &layout, QString &error);
+
+    /*!
+     * \brief ~ResultWriter writes the remaining rows, closes the file and only then releases the file path, so a
+     * writer opened on the same path afterwards never truncates rows that are still being flushed.
+     */
+    ~ResultWriter();
+
+    QString filePath() const;
+
+    Format format() const;
+
+    /*!
+     * \brief writesSnapshots
+     * \return True if the format stores intermediate snapshots. CSV files only store results.
+     */
+    bool writesSnapshots() const;
+
+    /*!
+     * \brief write queues a result row without blocking. Safe to call concurrently.
+     * \param runId
+     * \param iteration
+     * \param values
+     */
+    void write(const QString &runId, int iteration, const std::vector<double> &values);
+
+    /*!
+     * \brief writeSnapshot queues the values of a run at an intermediate time without blocking. Safe to call concurrently.
+     * \param runId
+     * \param iteration
+     * \param dateTime
+     * \param values
+     */
+    void writeSnapshot(const QString &runId, int iteration, double dateTime, const std::vector<double> &values);
+
+  private:
+
+    struct Record
+    {
+      Record *next;
+      QString runId;
+      int iteration;
+      bool snapshot;
+      double dateTime;
+      std::vector<double> values;
+    };
+
+    ResultWriter(const QString &filePath, Format format, const ResultLayout &layout);
+
+    Q_DISABLE_COPY(ResultWriter)
+
+    bool isOpen() const;
+
+    void push(Record *record);
+
+    void run();
+
+    void writeRecords(Record *records);
+
+    bool openCSV();
+
+    void writeCSV(Record *records);
+
+    bool openBinary();
+
+    void writeBinary(Record *records);
+
+    /*!
+     * \brief blockValues scatters the values of a row into an (objective, geometry, metric) block.
+     * \param values
+     * \param block
+     */
+    void blockValues(const std::vector<double> &values, std::vector<double> &block) const;
+
+#ifdef USE_NETCDF
+    bool openNetCDF();
+
+    void writeNetCDF(Record *records);
+#endif
+
+  private:
+
+    static const int m_batchSize;
+    static const int m_flushInterval;
+    static const int m_runIdSize;
+    QFile m_file;
+    Format m_format;
+    ResultLayout m_layout;
+    bool m_open, m_registered;
+    size_t m_rowCount, m_snapshotCount;
+    std::vector<double> m_block;
+#ifdef USE_NETCDF
+    netCDF::NcFile *m_ncFile;
+#endif
+    std::atomic<Record*> m_records;
+    std::atomic<int> m_pendingRecords;
+    std::atomic<bool> m_stop;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+};
+
+#endif // RESULTWRITER_H
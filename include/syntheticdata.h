@@ -0,0 +1,111 @@
+/*!
+ *  \file    syntheticdata.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <QString>
+
+/*!
+ * \brief The SyntheticDataOptions struct describes the size of a synthetic benchmark problem.
+ */
+struct SyntheticDataOptions
+{
+  /*!
+   * \brief timeSteps Number of observation times before gaps are removed.
+   */
+  int timeSteps = 8760;
+
+  /*!
+   * \brief geometries Number of linestring geometries shared by the observations and the provider.
+   */
+  int geometries = 1000;
+
+  /*!
+   * \brief stepRatio Number of provider time steps per observation time step.
+   */
+  int stepRatio = 4;
+
+  /*!
+   * \brief gapDensity Fraction of observation times that are missing from the observation series.
+   */
+  double gapDensity = 0.05;
+
+  /*!
+   * \brief observationStep Observation time step in days.
+   */
+  double observationStep = 1.0 / 24.0;
+
+  unsigned int seed = 42;
+};
+
+/*!
+ * \brief The SyntheticData class writes a synthetic objective function problem, i.e., an input file,
+ * an observation time series and a shapefile of linestring geometries, for benchmarking the component
+ * against a SyntheticProviderComponent.
+ */
+class SyntheticData
+{
+  public:
+
+    /*!
+     * \brief generate writes the synthetic problem to a directory.
+     * \param options
+     * \param directory Existing directory that receives the files.
+     * \param inputFile Receives the path of the generated input file.
+     * \param geometryFile Receives the path of the generated shapefile.
+     * \param error
+     * \return False if any of the files could not be written.
+     */
+    static bool generate(const SyntheticDataOptions &options, const QString &directory,
+                         QString &inputFile, QString &geometryFile, QString &error);
+
+    /*!
+     * \brief startDateTime
+     * \return Julian day of the first observation time.
+     */
+    static double startDateTime();
+
+    /*!
+     * \brief endDateTime
+     * \param options
+     * \return Julian day of the last observation time.
+     */
+    static double endDateTime(const SyntheticDataOptions &options);
+
+    /*!
+     * \brief simulatedValue is the synthetic model response of a geometry that the provider reports and from
+     * which the observations are perturbed.
+     * \param geometryIndex
+     * \param julianDay
+     * \return
+     */
+    static double simulatedValue(int geometryIndex, double julianDay);
+
+  private:
+
+    static bool writeGeometries(const SyntheticDataOptions &options, const QString &filePath, QString &error);
+
+    static bool writeObservations(const SyntheticDataOptions &options, const QString &filePath, QString &error);
+
+    static bool writeInputFile(const SyntheticDataOptions &options, const QString &filePath,
+                               const QString &observationFile, const QString &geometryFile, QString &error);
+};
+
+#endif // SYNTHETICDATA_H
@@ -0,0 +1,152 @@
+/*!
+ *  \file    syntheticprovider.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef SYNTHETICPROVIDER_H
+#define SYNTHETICPROVIDER_H
+
+#include "temporal/abstracttimemodelcomponent.h"
+#include "core/abstractmodelcomponentinfo.h"
+#include "spatiotemporal/timegeometryoutput.h"
+#include "syntheticdata.h"
+
+#include <vector>
+
+class Dimension;
+class GeometrySet;
+class SyntheticProviderComponent;
+
+/*!
+ * \brief The SyntheticProviderComponentInfo class describes the stand-in model used by the benchmarks.
+ */
+class SyntheticProviderComponentInfo : public AbstractModelComponentInfo
+{
+    Q_OBJECT
+
+  public:
+
+    SyntheticProviderComponentInfo(QObject *parent = nullptr);
+
+    virtual ~SyntheticProviderComponentInfo();
+
+    HydroCouple::IModelComponent* createComponentInstance() override;
+};
+
+/*!
+ * \brief The SyntheticProviderOutput class reports SyntheticData::simulatedValue for every geometry. Only the
+ * previous and current time slots are kept, so memory does not grow with the number of time steps.
+ */
+class SyntheticProviderOutput : public TimeGeometryOutputDouble
+{
+    Q_OBJECT
+
+  public:
+
+    SyntheticProviderOutput(const QString &id,
+                            Dimension *timeDimension,
+                            Dimension *geometryDimension,
+                            ValueDefinition *valueDefinition,
+                            SyntheticProviderComponent *component);
+
+    virtual ~SyntheticProviderOutput();
+
+    void updateValues(HydroCouple::IInput *querySpecifier) override;
+
+    void updateValues() override;
+
+    /*!
+     * \brief advance moves the current time slot to the previous slot and fills the current slot.
+     * \param julianDay
+     */
+    void advance(double julianDay);
+
+  private:
+
+    SyntheticProviderComponent *m_component;
+    std::vector<double> m_values;
+};
+
+/*!
+ * \brief The SyntheticProviderComponent class is a stand-in model that steps through the synthetic problem
+ * at SyntheticDataOptions::stepRatio steps per observation step and exposes a single SyntheticProviderOutput.
+ */
+class SyntheticProviderComponent : public AbstractTimeModelComponent
+{
+    Q_OBJECT
+
+  public:
+
+    SyntheticProviderComponent(const QString &id, SyntheticProviderComponentInfo *modelComponentInfo);
+
+    virtual ~SyntheticProviderComponent();
+
+    /*!
+     * \brief setSyntheticData sets the problem to simulate. Must be called before initialize.
+     * \param options
+     * \param geometryFile Shapefile written by SyntheticData::generate.
+     */
+    void setSyntheticData(const SyntheticDataOptions &options, const QString &geometryFile);
+
+    QList<QString> validate() override;
+
+    void prepare() override;
+
+    void update(const QList<HydroCouple::IOutput*> &requiredOutputs = QList<HydroCouple::IOutput*>()) override;
+
+    void finish() override;
+
+    SyntheticProviderOutput *output() const;
+
+    /*!
+     * \brief timeStep
+     * \return Time step in days.
+     */
+    double timeStep() const;
+
+    /*!
+     * \brief stepCount
+     * \return Number of time steps taken since prepare.
+     */
+    int stepCount() const;
+
+  protected:
+
+    void initializeFailureCleanUp() override;
+
+  private:
+
+    void createArguments() override;
+
+    bool initializeArguments(QString &message) override;
+
+    void createInputs() override;
+
+    void createOutputs() override;
+
+  private:
+
+    SyntheticDataOptions m_options;
+    QString m_geometryFile;
+    QSharedPointer<GeometrySet> m_geometrySet;
+    Dimension *m_timeDimension, *m_geometryDimension;
+    SyntheticProviderOutput *m_output;
+    double m_timeStep;
+    int m_stepCount;
+};
+
+#endif // SYNTHETICPROVIDER_H
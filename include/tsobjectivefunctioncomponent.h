@@ -7,14 +7,26 @@
 #include "temporal/abstracttimemodelcomponent.h"
 #include "spatial/geometry.h"
 #include "temporal/timeseries.h"
+#include "resultwriter.h"
+#include "objectivestatisticskernel.h"
 
 #include <unordered_map>
-#include <QTextStream>
 
 class TSObjectiveFunctionComponentInfo;
 class Dimension;
 class ObjectiveInput;
 class ObjectiveOutput;
+class ObservationSeries;
+class GeometrySet;
+class ProviderGeometryIndex;
+
+namespace HydroCouple
+{
+  namespace SpatioTemporal
+  {
+    class ITimeGeometryComponentDataItem;
+  }
+}
 
 class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public AbstractTimeModelComponent,
     public virtual HydroCouple::ICloneableModelComponent
@@ -25,11 +37,34 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public
 
   public:
 
+    /*!
+     * \brief The Algorithm enum lists the supported objective functions. All values are
+     * reported so that smaller is better, i.e., efficiencies are reported as one minus the efficiency.
+     */
     enum Algorithm
     {
       NashSutcliff,
       RMSE,
       MAE,
+      KlingGupta,
+      PercentBias,
+      LogNashSutcliff,
+      RSquared,
+    };
+
+    /*!
+     * \brief The DistributedMode enum specifies how objectives are combined across MPI ranks. Modes other than
+     * Local require MPI to be initialized by the host before the component is initialized. The TSObjectiveFunctionComponent
+     * application initializes MPI itself.
+     */
+    enum DistributedMode
+    {
+      //! Every rank evaluates and writes its own objectives.
+      Local,
+      //! Ranks hold partitions of a domain decomposed model. Statistics are reduced across ranks and rank 0 writes the objectives.
+      DecomposedDomain,
+      //! Every rank runs different ensemble members. Rank 0 gathers and writes the objectives of all members when the parent finishes.
+      Ensemble,
     };
 
     /*!
@@ -84,9 +119,69 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public
      */
     QList<HydroCouple::ICloneableModelComponent*> clones() const override;
 
+    /*!
+     * \brief reset returns an initialized component to the state it had right after initialization without
+     * reading its input files again. Statistics are cleared, inputs are rewound to the start of the
+     * simulation horizon and output values are cleared.
+     * \return False if the component is not initialized.
+     */
+    bool reset();
+
 
     void applyInputValues() override;
 
+    /*!
+     * \brief retainHistory
+     * \return True if objective inputs keep every simulated time slot. When false,
+     * inputs only keep the latest slot and objectives are computed from running statistics.
+     */
+    bool retainHistory() const;
+
+    /*!
+     * \brief isPruned
+     * \return True if the run was stopped before the end of the simulation horizon because the lower bound of an
+     * objective exceeded its PRUNE_THRESHOLD. The component is then Done and its outputs hold
+     * std::numeric_limits<double>::max(), so drivers can abort the coupled run.
+     */
+    bool isPruned() const;
+
+    /*!
+     * \brief runningOutputsDue
+     * \return True if objective outputs publish the metrics of the statistics accumulated so far at the current
+     * time step, i.e., every RUNNING_OUTPUT_STEPS time steps.
+     */
+    bool runningOutputsDue() const;
+
+    /*!
+     * \brief tryParseAlgorithm
+     * \param name Algorithm name as specified in the input file, e.g., NASH_SUTCLIFF.
+     * \param algorithm
+     * \return
+     */
+    static bool tryParseAlgorithm(const QString &name, Algorithm &algorithm);
+
+    /*!
+     * \brief algorithmName
+     * \param algorithm
+     * \return Input file name of the algorithm.
+     */
+    static QString algorithmName(Algorithm algorithm);
+
+    /*!
+     * \brief providerGeometryIndex returns the geometry index of a provider, building it the first time an
+     * input is linked to the provider.
+     * \param provider
+     * \return
+     */
+    QSharedPointer<ProviderGeometryIndex> providerGeometryIndex(HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem *provider);
+
+    /*!
+     * \brief releaseProviderGeometryIndex drops the geometry index of a provider an input was unlinked from.
+     * Indexes are keyed by address, so they must not outlive the link to the provider.
+     * \param provider
+     */
+    void releaseProviderGeometryIndex(HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem *provider);
+
   protected:
 
     /*!
@@ -96,6 +191,12 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public
      */
     bool removeClone(TSObjectiveFunctionComponent *component);
 
+    /*!
+     * \brief discardClone unlinks a pooled clone from its providers, removes and deletes it.
+     * \param component
+     */
+    void discardClone(TSObjectiveFunctionComponent *component);
+
     /*!
      * \brief initializeFailureCleanUp
      */
@@ -103,6 +204,8 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public
 
   private:
 
+    struct ResultRow;
+
     /*!
      * \brief createArguments
      */
@@ -127,6 +230,30 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public
      */
     bool initializeInputFilesArguments(QString &message);
 
+    /*!
+     * \brief readInputFile parses the options, objectives and objective geometries of the input file and
+     * records the files they were read from.
+     * \param inputFile
+     * \param message
+     * \return
+     */
+    bool readInputFile(const QFileInfo &inputFile, QString &message);
+
+    /*!
+     * \brief sourcesUnchanged
+     * \param inputFile
+     * \return True if the input file and every file read while parsing it are unchanged since they were last read.
+     */
+    bool sourcesUnchanged(const QFileInfo &inputFile) const;
+
+    void addSourceFile(const QFileInfo &file);
+
+    /*!
+     * \brief releaseRuntimeState releases the inputs, outputs and output file of a run while keeping the parsed
+     * options, observations and geometries.
+     */
+    void releaseRuntimeState();
+
     /*!
      * \brief createInputs
      */
@@ -140,39 +267,164 @@ class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT TSObjectiveFunctionComponent : public
 
     /*!
      * \brief getMinDate
-     * \return
+     * \return The earliest current observation time of all inputs.
      */
     double getMinDate() const;
 
     /*!
-     * \brief writeObjectiveFunctionValues
+     * \brief evaluateObjectives computes the values of all objective outputs once the simulation horizon has
+     * been reached. Outputs are evaluated in parallel when OpenMP is enabled and the problem is large enough.
+     * \return False if the statistics of a decomposed domain could not be reduced across MPI ranks.
+     */
+    bool evaluateObjectives();
+
+    /*!
+     * \brief sortUpdateOrder restores the ordering of the inputs by their current observation time
+     * after inputs have advanced.
+     */
+    void sortUpdateOrder();
+
+    /*!
+     * \brief pruneThresholdExceeded checks the lower bounds of the objectives with a PRUNE_THRESHOLD. Runs of a
+     * domain decomposed across MPI ranks are not pruned, since the partial statistics of a rank do not bound the
+     * reduced metric and the ranks meet in a collective reduction.
+     * \param message Describes the objective that exceeded its threshold.
+     * \return
+     */
+    bool pruneThresholdExceeded(QString &message) const;
+
+    /*!
+     * \brief openResultWriters acquires the writers of the output files shared with the parent and clones.
+     */
+    void openResultWriters();
+
+    /*!
+     * \brief writeObjectiveFunctionValues queues a row of objective function values with the result writer.
      */
     void writeOutput();
 
+    /*!
+     * \brief writeSnapshot queues the objective function values evaluated from the statistics accumulated so far
+     * with the result writers that store snapshots.
+     * \param dateTime
+     */
+    void writeSnapshot(double dateTime);
+
+    /*!
+     * \brief writeResultRow queues a result or snapshot row with the result writers. Rows of ensemble members on
+     * ranks other than 0 are sent to rank 0 in batches of m_ensembleBatchSize rows.
+     * \param row
+     */
+    void writeResultRow(ResultRow &row);
+
+    /*!
+     * \brief queueResultRow hands a row to the result writers of this component.
+     * \param row
+     */
+    void queueResultRow(const ResultRow &row);
+
+    /*!
+     * \brief sendEnsembleRows sends the rows buffered by the parent component on a rank other than 0 to rank 0.
+     */
+    void sendEnsembleRows();
+
+    /*!
+     * \brief receiveEnsembleRows writes the rows sent by the other ranks on rank 0.
+     * \param waitForRanks Waits until every other rank has sent all of its rows. Otherwise only writes the rows that
+     * have already arrived.
+     */
+    void receiveEnsembleRows(bool waitForRanks);
+
+    /*!
+     * \brief finishEnsembleRows sends the remaining rows of every rank to rank 0 and waits on rank 0 until all have
+     * been written. This is a collective call made once by every parent component when it finishes. Members must
+     * finish before their parent and a process runs one ensemble parent.
+     */
+    void finishEnsembleRows();
+
+    /*!
+     * \brief runId
+     * \return Identifier of the rows written by this component in the output files.
+     */
+    QString runId() const;
+
+    /*!
+     * \brief readBoolean
+     * \param value
+     * \param result
+     * \return
+     */
+    static bool readBoolean(const QString &value, bool &result);
+
   private:
 
+    /*!
+     * \brief The PruneThreshold struct stops a run once the lower bound of an objective metric exceeds the threshold.
+     */
+    struct PruneThreshold
+    {
+      int objective;
+      Algorithm algorithm;
+      double threshold;
+    };
+
+    /*!
+     * \brief The ResultRow struct holds a result or snapshot row, buffered on ranks other than 0 until it is sent
+     * to rank 0 by ensemble runs.
+     */
+    struct ResultRow
+    {
+      QString runId;
+      int iteration;
+      bool snapshot;
+      double dateTime;
+      std::vector<double> values;
+    };
+
     Dimension *m_timeDimension,
               *m_geometryDimension;
 
     TSObjectiveFunctionComponent *m_parent;
     QList<HydroCouple::ICloneableModelComponent*> m_clones;
+    QList<TSObjectiveFunctionComponent*> m_pooledClones;
     IdBasedArgumentString *m_inputFilesArgument;
     static const std::unordered_map<std::string,int> m_inputFileFlags;
     static const std::unordered_map<std::string,int> m_optionsFlags;
 
     std::vector<std::string> m_objectiveNames;
     std::vector<std::string> m_objectiveDesc;
-    std::vector<Algorithm> m_algorithms;
-    std::vector<TimeSeries*> m_inputTSFiles;
+    std::vector<std::vector<Algorithm>> m_algorithms;
+    std::vector<QSharedPointer<ObservationSeries>> m_inputTSFiles;
+    std::vector<std::string> m_inputTSKeys;
     std::unordered_map<std::string, QList<QSharedPointer<HCGeometry>>> m_geometries;
+    std::vector<QSharedPointer<GeometrySet>> m_geometrySets;
+    std::vector<std::pair<QString, qint64>> m_sourceFiles;
     std::vector<ObjectiveOutput*> m_objectiveOutputs;
     std::vector<ObjectiveInput*> m_objectiveInputs;
+    std::vector<int> m_updateOrder;
+    std::vector<std::pair<HydroCouple::IOutput*, double>> m_updatedProviders;
+    std::unordered_map<HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem*, QSharedPointer<ProviderGeometryIndex>> m_providerGeometryIndexes;
+    std::vector<PruneThreshold> m_pruneThresholds;
+    std::vector<ResultRow> m_ensembleRows;
 
-    QFileInfo m_outputCSVFile;
-    QTextStream m_outputCSVStream;
+    std::vector<std::pair<QFileInfo, ResultWriter::Format>> m_outputFiles;
+    std::vector<QSharedPointer<ResultWriter>> m_resultWriters;
+    QString m_runId;
 
     double m_startDate, m_endDate;
+    bool m_retainHistory;
+    ObjectiveStatisticsKernel::Kernel m_statisticsKernel;
+    bool m_observationCache, m_batchUpdate, m_clonePool;
+    DistributedMode m_distributedMode;
+    double m_timeTolerance;
+    double m_snapshotInterval, m_nextSnapshotTime;
+    bool m_pruned;
+    int m_runningOutputSteps, m_stepCount;
+    int m_iteration;
+    int m_finishedEnsembleRanks;
+    static const double m_defaultTimeTolerance;
     static const QRegExp m_dateTimeDelim;
+    static const int m_ensembleBatchSize;
 };
 
 Q_DECLARE_METATYPE(TSObjectiveFunctionComponent*)
@@ -0,0 +1,63 @@
+/*!
+ *  \file    valuearraydata.h
+ *  \author  Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ *  \version 1.0.0
+ *  \section Description
+ *  This file and its associated files and libraries are free software;
+ *  you can redistribute it and/or modify it under the terms of the
+ *  Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ *  either version 3 of the License, or (at your option) any later version.
+ *  fvhmcompopnent.h its associated files is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ *  \date 2018
+ *  \pre
+ *  \bug
+ *  \todo
+ *  \warning
+ */
+
+#ifndef VALUEARRAYDATA_H
+#define VALUEARRAYDATA_H
+
+#include "tsobjectivefunctioncomponent_global.h"
+
+/*!
+ * \brief The ITimeGeometryValueArray class is an optional interface for time-geometry exchange items that
+ * store each time slice as a contiguous array of doubles. Inputs detect it on their provider and read
+ * whole slices directly instead of calling getValue for every geometry.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT ITimeGeometryValueArray
+{
+  public:
+
+    virtual ~ITimeGeometryValueArray() {}
+
+    /*!
+     * \brief timeSliceValues
+     * \param timeIndex
+     * \return Pointer to the geometryCount() contiguous values at timeIndex or null if the slice is not
+     * stored contiguously. The pointer remains valid until the exchange item is next updated.
+     */
+    virtual const double *timeSliceValues(int timeIndex) const = 0;
+};
+
+/*!
+ * \brief The IGeometryValueArray class is an optional interface for geometry exchange items that store
+ * their values as a contiguous array of doubles.
+ */
+class TSOBJECTIVEFUNCTIONCOMPONENT_EXPORT IGeometryValueArray
+{
+  public:
+
+    virtual ~IGeometryValueArray() {}
+
+    /*!
+     * \brief geometryValues
+     * \return Pointer to the geometryCount() contiguous values or null if none are available.
+     * The pointer remains valid until the exchange item is next updated.
+     */
+    virtual const double *geometryValues() const = 0;
+};
+
+#endif // VALUEARRAYDATA_H
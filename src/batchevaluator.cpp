@@ -0,0 +1,361 @@
+#include "stdafx.h"
+#include "batchevaluator.h"
+#include "tsobjectivefunctioncomponentinfo.h"
+#include "objectiveinput.h"
+#include "objectiveoutput.h"
+#include "objectivestatisticsarray.h"
+#include "observationindex.h"
+#include "observationseries.h"
+#include "core/idbasedargument.h"
+#include "temporal/timedata.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace HydroCouple;
+
+BatchEvaluator::BatchEvaluator()
+  : m_componentInfo(nullptr),
+    m_component(nullptr),
+    m_columnCount(0)
+{
+
+}
+
+BatchEvaluator::~BatchEvaluator()
+{
+  finish();
+}
+
+bool BatchEvaluator::initialize(const QString &inputFile, QString &error)
+{
+  finish();
+
+  QFileInfo inputFileInfo(inputFile);
+
+  m_componentInfo = new TSObjectiveFunctionComponentInfo();
+  m_component = dynamic_cast<TSObjectiveFunctionComponent*>(m_componentInfo->createComponentInstance());
+  m_component->setReferenceDirectory(inputFileInfo.absolutePath());
+
+  for(IArgument *argument : m_component->arguments())
+  {
+    IdBasedArgumentString *inputFilesArgument = dynamic_cast<IdBasedArgumentString*>(argument);
+
+    if(inputFilesArgument && inputFilesArgument->id() == "InputFiles")
+    {
+      (*inputFilesArgument)["Input File"] = inputFileInfo.absoluteFilePath();
+    }
+  }
+
+  m_component->initialize();
+
+  if(m_component->status() != IModelComponent::Initialized)
+  {
+    error = "Unable to initialize objectives from input file: " + inputFileInfo.absoluteFilePath();
+    return false;
+  }
+
+  double startTime = m_component->timeHorizon()->julianDay();
+  double endTime = startTime + m_component->timeHorizon()->duration();
+
+  for(IInput *input : m_component->inputs())
+  {
+    ObjectiveInput *objectiveInput = dynamic_cast<ObjectiveInput*>(input);
+
+    if(objectiveInput)
+    {
+      Objective objective;
+      objective.input = objectiveInput;
+      objective.alignedRows = ObservationIndex::alignedRows(objectiveInput->timeSeriesKey(), objectiveInput->timeSeries(),
+                                                            startTime, endTime, objectiveInput->timeTolerance());
+      objective.columnOffset = m_columnCount;
+
+      m_columnCount += objectiveInput->geometryCount();
+      m_objectives.push_back(objective);
+    }
+  }
+
+  for(IOutput *output : m_component->outputs())
+  {
+    ObjectiveOutput *objectiveOutput = dynamic_cast<ObjectiveOutput*>(output);
+
+    if(objectiveOutput)
+    {
+      for(size_t i = 0; i < m_objectives.size(); i++)
+      {
+        if(m_objectives[i].input == objectiveOutput->objectiveInput())
+        {
+          m_outputs.push_back(objectiveOutput);
+          m_outputObjectives.push_back(static_cast<int>(i));
+          break;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+int BatchEvaluator::columnCount() const
+{
+  return m_columnCount;
+}
+
+bool BatchEvaluator::evaluate(const QStringList &simulationFiles, QTextStream &results, QString &error) const
+{
+  error = "";
+  writeHeader(results);
+
+  int runCount = simulationFiles.size();
+  int blockSize = 1;
+
+#ifdef USE_OPENMP
+  blockSize = 4 * omp_get_max_threads();
+#endif
+
+  //Runs are scored in blocks so that rows are written in order while memory stays bounded for large archives.
+  for(int blockStart = 0; blockStart < runCount; blockStart += blockSize)
+  {
+    int blockCount = std::min(blockSize, runCount - blockStart);
+    std::vector<std::vector<double>> blockValues(blockCount);
+    std::vector<QString> blockErrors(blockCount);
+    std::vector<char> blockSuccess(blockCount, 0);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for(int i = 0; i < blockCount; i++)
+    {
+      blockSuccess[i] = evaluateRun(simulationFiles[blockStart + i], blockValues[i], blockErrors[i]);
+    }
+
+    for(int i = 0; i < blockCount; i++)
+    {
+      if(blockSuccess[i])
+      {
+        results << simulationFiles[blockStart + i];
+
+        for(double value : blockValues[i])
+        {
+          results << ", " << value;
+        }
+
+        results << "\n";
+      }
+      else
+      {
+        error += simulationFiles[blockStart + i] + ": " + blockErrors[i] + "\n";
+      }
+    }
+
+    results.flush();
+  }
+
+  return error.isEmpty();
+}
+
+bool BatchEvaluator::evaluateRun(const QString &simulationFile, std::vector<double> &values, QString &error) const
+{
+  values.clear();
+
+  QFile file(simulationFile);
+
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    error = "Unable to open simulation file";
+    return false;
+  }
+
+  //NetCDF archives are recognized by extension or by the classic (CDF 1, 2 and 5) and netCDF-4/HDF5 signatures.
+  QString suffix = QFileInfo(simulationFile).suffix().toLower();
+  QByteArray signature = file.peek(4);
+
+  if(suffix == "nc" || suffix == "nc4" || suffix == "netcdf" ||
+     (signature.size() == 4 && signature.startsWith("CDF") && (signature[3] == '\x01' || signature[3] == '\x02' || signature[3] == '\x05')) ||
+     signature.startsWith("\x89HDF"))
+  {
+    error = "NetCDF simulation files are not supported yet";
+    return false;
+  }
+
+  QTextStream stream(&file);
+  QString line = stream.readLine();
+
+  //The delimiter is detected from the header line.
+  QChar delimiter = line.contains(',') ? QChar(',') : line.contains('\t') ? QChar('\t') : line.contains(';') ? QChar(';') : QChar(' ');
+
+  if(line.split(delimiter, QString::SkipEmptyParts).size() != m_columnCount + 1)
+  {
+    error = "Expected a date time column and " + QString::number(m_columnCount) + " simulated value columns";
+    return false;
+  }
+
+  size_t numObjectives = m_objectives.size();
+  std::vector<ObjectiveStatisticsArray> statistics(numObjectives);
+  std::vector<size_t> nextAlignedIndexes(numObjectives, 0);
+  int maxGeometryCount = 0;
+
+  for(size_t o = 0; o < numObjectives; o++)
+  {
+    statistics[o].setKernel(m_objectives[o].input->statisticsKernel());
+    statistics[o].resize(m_objectives[o].input->geometryCount());
+    maxGeometryCount = std::max(maxGeometryCount, m_objectives[o].input->geometryCount());
+  }
+
+  std::vector<double> previousValues(m_columnCount, 0.0), currentValues(m_columnCount, 0.0), simulatedValues(maxGeometryCount, 0.0);
+  double previousTime = 0.0;
+  bool hasPrevious = false;
+  int lineCount = 1;
+
+  while (!stream.atEnd())
+  {
+    line = stream.readLine();
+    lineCount++;
+
+    if(line.trimmed().isEmpty())
+      continue;
+
+    QVector<QStringRef> cols = line.splitRef(delimiter, QString::SkipEmptyParts);
+
+    if(cols.size() != m_columnCount + 1)
+    {
+      error = "Line " + QString::number(lineCount) + " : Expected " + QString::number(m_columnCount + 1) + " columns";
+      return false;
+    }
+
+    bool parsed = false;
+    double currentTime = cols[0].trimmed().toDouble(&parsed);
+
+    if(!parsed)
+    {
+      QDateTime dateTime;
+
+      if(SDKTemporal::DateTime::tryParse(cols[0].trimmed().toString(), dateTime))
+      {
+        currentTime = SDKTemporal::DateTime::toJulianDays(dateTime);
+      }
+      else
+      {
+        error = "Line " + QString::number(lineCount) + " : Error reading date time";
+        return false;
+      }
+    }
+
+    if(hasPrevious && currentTime < previousTime)
+    {
+      error = "Line " + QString::number(lineCount) + " : Date times must be increasing";
+      return false;
+    }
+
+    for(int c = 0; c < m_columnCount; c++)
+    {
+      currentValues[c] = cols[c + 1].trimmed().toDouble(&parsed);
+
+      if(!parsed)
+      {
+        error = "Line " + QString::number(lineCount) + " : Error reading simulated value";
+        return false;
+      }
+    }
+
+    //Every observation up to the current time is interpolated from the previous and current rows. Observations
+    //before the first row take the first row's values as providers do.
+    for(size_t o = 0; o < numObjectives; o++)
+    {
+      const Objective &objective = m_objectives[o];
+      const std::vector<int> &alignedRows = *objective.alignedRows;
+      ObservationSeries *timeSeries = objective.input->timeSeries();
+      double timeTolerance = objective.input->timeTolerance();
+      int geometryCount = objective.input->geometryCount();
+      size_t &nextAlignedIndex = nextAlignedIndexes[o];
+
+      while (nextAlignedIndex < alignedRows.size() &&
+             timeSeries->dateTime(alignedRows[nextAlignedIndex]) <= currentTime + timeTolerance)
+      {
+        int row = alignedRows[nextAlignedIndex];
+        double observationTime = timeSeries->dateTime(row);
+        const double *current = currentValues.data() + objective.columnOffset;
+
+        if(hasPrevious && observationTime >= previousTime - timeTolerance)
+        {
+          const double *previous = previousValues.data() + objective.columnOffset;
+          double factor = currentTime > previousTime ? std::min(1.0, std::max(0.0, (observationTime - previousTime) / (currentTime - previousTime))) : 0.0;
+
+          for(int g = 0; g < geometryCount; g++)
+          {
+            simulatedValues[g] = previous[g] + factor * (current[g] - previous[g]);
+          }
+        }
+        else
+        {
+          std::copy(current, current + geometryCount, simulatedValues.begin());
+        }
+
+        statistics[o].add(timeSeries->row(row), simulatedValues.data());
+
+        if(objective.input->accumulateLogarithmicStatistics())
+        {
+          statistics[o].addLogarithmic(timeSeries->row(row), simulatedValues.data());
+        }
+
+        nextAlignedIndex++;
+      }
+    }
+
+    std::swap(previousValues, currentValues);
+    previousTime = currentTime;
+    hasPrevious = true;
+  }
+
+  for(size_t i = 0; i < m_outputs.size(); i++)
+  {
+    const ObjectiveStatisticsArray &outputStatistics = statistics[m_outputObjectives[i]];
+    size_t offset = values.size();
+
+    values.resize(offset + outputStatistics.size());
+    outputStatistics.metrics(m_outputs[i]->algorithm(), values.data() + offset);
+  }
+
+  return true;
+}
+
+void BatchEvaluator::finish()
+{
+  m_objectives.clear();
+  m_outputs.clear();
+  m_outputObjectives.clear();
+  m_columnCount = 0;
+
+  if(m_component)
+  {
+    m_component->finish();
+    delete m_component;
+    m_component = nullptr;
+  }
+
+  delete m_componentInfo;
+  m_componentInfo = nullptr;
+}
+
+void BatchEvaluator::writeHeader(QTextStream &results) const
+{
+  results << "Run";
+
+  for(ObjectiveOutput *objectiveOutput : m_outputs)
+  {
+    for(int j = 0; j < objectiveOutput->geometryCount(); j++)
+    {
+      results << ", " << objectiveOutput->id();
+    }
+  }
+
+  results << "\n";
+  results.flush();
+}
@@ -0,0 +1,137 @@
+#include "stdafx.h"
+#include "geometrystore.h"
+#include "hydrocouplespatial.h"
+#include "spatial/envelope.h"
+#include "spatial/geometryfactory.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+using namespace HydroCouple::Spatial;
+
+namespace
+{
+  QMutex &storeMutex()
+  {
+    static QMutex mutex;
+    return mutex;
+  }
+
+  QHash<QString, QWeakPointer<GeometrySet>> &storeEntries()
+  {
+    static QHash<QString, QWeakPointer<GeometrySet>> entries;
+    return entries;
+  }
+
+  /*!
+   * \brief pruneEntries drops entries no component holds anymore and entries of earlier versions of the file
+   * whose versioned key starts with \p filePrefix. Must be called with the store mutex held.
+   */
+  void pruneEntries(const QString &filePrefix)
+  {
+    QHash<QString, QWeakPointer<GeometrySet>> &entries = storeEntries();
+
+    for(auto it = entries.begin(); it != entries.end();)
+    {
+      if(it.value().isNull() || (!filePrefix.isEmpty() && it.key().startsWith(filePrefix)))
+      {
+        it = entries.erase(it);
+      }
+      else
+      {
+        it++;
+      }
+    }
+  }
+}
+
+GeometrySet::GeometrySet(const QList<HCGeometry*> &geometries)
+{
+  for(HCGeometry *geometry : geometries)
+  {
+    m_geometries.push_back(QSharedPointer<HCGeometry>(geometry));
+  }
+}
+
+const QList<QSharedPointer<HCGeometry>> &GeometrySet::geometries() const
+{
+  return m_geometries;
+}
+
+QSharedPointer<GeometrySet> GeometryStore::shapefileGeometries(const QFileInfo &file, QString &error)
+{
+  QString key = "SHAPEFILE|" + file.absoluteFilePath() + "|" + QString::number(file.lastModified().toMSecsSinceEpoch());
+
+  //Loading is done under the lock so that clones initializing concurrently read a file only once.
+  QMutexLocker locker(&storeMutex());
+
+  QSharedPointer<GeometrySet> geometrySet = storeEntries().value(key).toStrongRef();
+
+  if(geometrySet.isNull())
+  {
+    QList<HCGeometry*> geometries;
+    Envelope envp;
+
+    if(GeometryFactory::readGeometryFromFile(file.absoluteFilePath(), geometries, envp, error))
+    {
+      geometrySet = QSharedPointer<GeometrySet>(new GeometrySet(geometries));
+
+      //Components still holding an earlier version of the shapefile keep it alive without the store.
+      pruneEntries(key.left(key.lastIndexOf('|') + 1));
+      storeEntries()[key] = geometrySet;
+    }
+    else
+    {
+      qDeleteAll(geometries);
+      storeEntries().remove(key);
+    }
+  }
+
+  return geometrySet;
+}
+
+QSharedPointer<GeometrySet> GeometryStore::wktGeometries(const QString &wkt, QString &error)
+{
+  QString key = "WKT|" + QString::fromLatin1(QCryptographicHash::hash(wkt.toUtf8(), QCryptographicHash::Sha1).toHex());
+
+  QMutexLocker locker(&storeMutex());
+
+  QSharedPointer<GeometrySet> geometrySet = storeEntries().value(key).toStrongRef();
+
+  if(geometrySet.isNull())
+  {
+    HCGeometry *geometry = GeometryFactory::importFromWkt(wkt);
+
+    if(geometry)
+    {
+      QList<HCGeometry*> geometries;
+      geometries.push_back(geometry);
+
+      geometrySet = QSharedPointer<GeometrySet>(new GeometrySet(geometries));
+
+      //WKT keys are content hashes and have no earlier versions.
+      pruneEntries(QString());
+      storeEntries()[key] = geometrySet;
+    }
+    else
+    {
+      error = "Unable to parse WKT geometry";
+      storeEntries().remove(key);
+    }
+  }
+
+  return geometrySet;
+}
+
+int GeometryStore::count()
+{
+  QMutexLocker locker(&storeMutex());
+
+  pruneEntries(QString());
+
+  return storeEntries().size();
+}
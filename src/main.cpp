@@ -1,7 +1,222 @@
 #include "stdafx.h"
+#include "batchevaluator.h"
+#include "objectivebenchmark.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtTest>
+
+#include <cstdio>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+namespace
+{
+  /*!
+   * \brief The MPISession struct initializes MPI for the lifetime of the application, so the MPI_MODE options
+   * of the component and the MPI checks of the benchmark work when the application is started with mpirun.
+   */
+  struct MPISession
+  {
+    MPISession(int &argc, char **&argv)
+    {
+#ifdef USE_MPI
+      MPI_Init(&argc, &argv);
+#else
+      Q_UNUSED(argc)
+      Q_UNUSED(argv)
+#endif
+    }
+
+    ~MPISession()
+    {
+#ifdef USE_MPI
+      MPI_Finalize();
+#endif
+    }
+  };
+
+  /*!
+   * \brief readRunList reads simulation file paths, one per line, relative to the list file's directory.
+   * \param listFile
+   * \param simulationFiles
+   * \return
+   */
+  bool readRunList(const QString &listFile, QStringList &simulationFiles)
+  {
+    QFile file(listFile);
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+      return false;
+
+    QDir directory = QFileInfo(listFile).absoluteDir();
+    QTextStream stream(&file);
+
+    while (!stream.atEnd())
+    {
+      QString line = stream.readLine().trimmed();
+
+      if(!line.isEmpty() && !line.startsWith(";;"))
+      {
+        simulationFiles.append(directory.absoluteFilePath(line));
+      }
+    }
+
+    return true;
+  }
+
+  int runBenchmark(const QCommandLineParser &parser, const QCommandLineOption &stepsOption, const QCommandLineOption &geometriesOption,
+                   const QCommandLineOption &stepRatioOption, const QCommandLineOption &gapDensityOption,
+                   const QCommandLineOption &seedOption, const QCommandLineOption &microOption)
+  {
+    SyntheticDataOptions options;
+    options.timeSteps = parser.value(stepsOption).toInt();
+    options.geometries = parser.value(geometriesOption).toInt();
+    options.stepRatio = parser.value(stepRatioOption).toInt();
+    options.gapDensity = parser.value(gapDensityOption).toDouble();
+    options.seed = parser.value(seedOption).toUInt();
+
+    ObjectiveBenchmark benchmark(options);
+
+    if(parser.isSet(microOption))
+    {
+      QStringList testArguments;
+      testArguments << QCoreApplication::applicationFilePath() << parser.positionalArguments();
+
+      return QTest::qExec(&benchmark, testArguments);
+    }
+
+    QTextStream report(stdout);
+    QString error;
+
+    if(!benchmark.runComponent(report, error))
+    {
+      QTextStream(stderr) << error << "\n";
+      return 1;
+    }
+
+    return 0;
+  }
+}
 
 int main(int argc, char** argv)
 {
+  MPISession mpiSession(argc, argv);
+  QCoreApplication application(argc, argv);
+  QCoreApplication::setApplicationName("TSObjectiveFunctionComponent");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Scores stored simulation outputs against the objectives of an input file and writes one result row "
+                                   "per simulation file. With --benchmark, benchmarks the component on a synthetic problem instead; "
+                                   "arguments after -- are passed to QTest when running the micro-benchmarks.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("simulations", "Simulation time series files to score.", "[simulations...]");
+
+  QCommandLineOption inputOption(QStringList() << "i" << "input", "Objective function input file (*.inp).", "file");
+  QCommandLineOption outputOption(QStringList() << "o" << "output", "Result CSV file. Results are written to the standard output if not set.", "file");
+  QCommandLineOption runsOption(QStringList() << "r" << "runs", "File listing simulation files, one per line.", "file");
+  QCommandLineOption threadsOption(QStringList() << "t" << "threads", "Number of threads used to score simulation files.", "count");
+
+  QCommandLineOption benchmarkOption("benchmark", "Benchmark the component on a synthetic problem.");
+  QCommandLineOption stepsOption("steps", "Benchmark: number of observation time steps.", "T", "8760");
+  QCommandLineOption geometriesOption("geometries", "Benchmark: number of geometries.", "G", "1000");
+  QCommandLineOption stepRatioOption("step-ratio", "Benchmark: provider time steps per observation time step.", "ratio", "4");
+  QCommandLineOption gapDensityOption("gap-density", "Benchmark: fraction of missing observation times.", "fraction", "0.05");
+  QCommandLineOption seedOption("seed", "Benchmark: random seed of the synthetic observations.", "seed", "42");
+  QCommandLineOption microOption("micro", "Benchmark: run the QBENCHMARK micro-benchmarks and checks instead of a complete simulation. "
+                                           "Run under mpirun to check the MPI reduction and ensemble output.");
+
+  parser.addOption(inputOption);
+  parser.addOption(outputOption);
+  parser.addOption(runsOption);
+  parser.addOption(threadsOption);
+  parser.addOption(benchmarkOption);
+  parser.addOption(stepsOption);
+  parser.addOption(geometriesOption);
+  parser.addOption(stepRatioOption);
+  parser.addOption(gapDensityOption);
+  parser.addOption(seedOption);
+  parser.addOption(microOption);
+
+  parser.process(application);
+
+  if(parser.isSet(benchmarkOption))
+  {
+    return runBenchmark(parser, stepsOption, geometriesOption, stepRatioOption, gapDensityOption, seedOption, microOption);
+  }
+
+  QTextStream errorStream(stderr);
+
+  if(!parser.isSet(inputOption))
+  {
+    errorStream << "An input file must be specified with --input\n";
+    return 1;
+  }
+
+#ifdef USE_OPENMP
+  if(parser.isSet(threadsOption) && parser.value(threadsOption).toInt() > 0)
+  {
+    omp_set_num_threads(parser.value(threadsOption).toInt());
+  }
+#endif
+
+  QStringList simulationFiles;
+
+  for(const QString &simulationFile : parser.positionalArguments())
+  {
+    simulationFiles.append(QFileInfo(simulationFile).absoluteFilePath());
+  }
+
+  if(parser.isSet(runsOption) && !readRunList(parser.value(runsOption), simulationFiles))
+  {
+    errorStream << "Unable to read run list: " << parser.value(runsOption) << "\n";
+    return 1;
+  }
+
+  BatchEvaluator evaluator;
+  QString error;
+
+  if(!evaluator.initialize(parser.value(inputOption), error))
+  {
+    errorStream << error << "\n";
+    return 1;
+  }
+
+  QFile outputFile;
+
+  if(parser.isSet(outputOption))
+  {
+    outputFile.setFileName(parser.value(outputOption));
+
+    if(!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+      errorStream << "Unable to write result file: " << parser.value(outputOption) << "\n";
+      return 1;
+    }
+  }
+  else
+  {
+    outputFile.open(stdout, QIODevice::WriteOnly);
+  }
+
+  QTextStream results(&outputFile);
+  results.setRealNumberPrecision(10);
+  results.setRealNumberNotation(QTextStream::SmartNotation);
+
+  if(!evaluator.evaluate(simulationFiles, results, error))
+  {
+    errorStream << error;
+    return 1;
+  }
 
-   return 0;
-}
\ No newline at end of file
+  return 0;
+}
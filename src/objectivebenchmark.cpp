@@ -0,0 +1,748 @@
+#include "stdafx.h"
+#include "objectivebenchmark.h"
+#include "tsobjectivefunctioncomponent.h"
+#include "tsobjectivefunctioncomponentinfo.h"
+#include "syntheticprovider.h"
+#include "objectiveinput.h"
+#include "objectivestatisticsarray.h"
+#include "providergeometryindex.h"
+#include "core/idbasedargument.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+using namespace HydroCouple;
+
+namespace
+{
+  /*!
+   * \brief mpiWorld
+   * \param rank
+   * \param size
+   * \return True if MPI is initialized and runs more than one rank.
+   */
+  bool mpiWorld(int &rank, int &size)
+  {
+    rank = 0;
+    size = 1;
+
+#ifdef USE_MPI
+    int initialized = 0, finalized = 0;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+
+    if(initialized && !finalized)
+    {
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+      MPI_Comm_size(MPI_COMM_WORLD, &size);
+    }
+#endif
+
+    return size > 1;
+  }
+
+  void linkComponents(TSObjectiveFunctionComponent *component, SyntheticProviderComponent *provider)
+  {
+    IOutput *output = provider->output();
+
+    for(IInput *input : component->inputs())
+    {
+      output->addConsumer(input);
+      input->setProvider(output);
+    }
+  }
+
+  void unlinkComponents(TSObjectiveFunctionComponent *component, SyntheticProviderComponent *provider)
+  {
+    IOutput *output = provider->output();
+
+    for(IInput *input : component->inputs())
+    {
+      if(output)
+      {
+        output->removeConsumer(input);
+      }
+
+      input->setProvider(nullptr);
+    }
+  }
+}
+
+Q_DECLARE_METATYPE(ObjectiveStatisticsArray::Kernel)
+Q_DECLARE_METATYPE(TSObjectiveFunctionComponent::Algorithm)
+
+ObjectiveBenchmark::ObjectiveBenchmark(const SyntheticDataOptions &options, QObject *parent)
+  : QObject(parent),
+    m_options(options),
+    m_directory(nullptr),
+    m_componentInfo(nullptr),
+    m_providerInfo(nullptr),
+    m_component(nullptr),
+    m_provider(nullptr)
+{
+
+}
+
+ObjectiveBenchmark::~ObjectiveBenchmark()
+{
+  finish();
+  delete m_directory;
+}
+
+bool ObjectiveBenchmark::runComponent(QTextStream &report, QString &error)
+{
+  const char *phases[] = {"Generate", "Initialize", "Connect", "Prepare", "Update", "Finish"};
+  double phaseTimes[6] = {0.0};
+
+  QElapsedTimer timer;
+  timer.start();
+
+  if(!generate(error))
+    return false;
+
+  phaseTimes[0] = timer.nsecsElapsed() * 1.0e-6;
+  timer.restart();
+
+  if(!initialize(error))
+    return false;
+
+  phaseTimes[1] = timer.nsecsElapsed() * 1.0e-6;
+  timer.restart();
+
+  link();
+
+  phaseTimes[2] = timer.nsecsElapsed() * 1.0e-6;
+  timer.restart();
+
+  if(!prepare(error))
+    return false;
+
+  phaseTimes[3] = timer.nsecsElapsed() * 1.0e-6;
+  timer.restart();
+
+  while (m_component->status() == IModelComponent::Updated)
+  {
+    m_component->update();
+  }
+
+  phaseTimes[4] = timer.nsecsElapsed() * 1.0e-6;
+
+  if(m_component->status() != IModelComponent::Done)
+  {
+    error = "Objective function component did not finish the simulation";
+    return false;
+  }
+
+  int providerSteps = m_provider->stepCount();
+  int observationSteps = objectiveInput()->recordLength();
+  int geometries = objectiveInput()->geometryCount();
+
+  timer.restart();
+
+  finish();
+
+  phaseTimes[5] = timer.nsecsElapsed() * 1.0e-6;
+
+  double updateSeconds = std::max(phaseTimes[4] * 1.0e-3, 1.0e-9);
+
+  report << "Synthetic problem: " << m_options.timeSteps << " time steps, " << m_options.geometries << " geometries, step ratio "
+         << m_options.stepRatio << ", gap density " << m_options.gapDensity << "\n";
+
+  for(int i = 0; i < 6; i++)
+  {
+    report << QString("%1 (ms)").arg(phases[i]).leftJustified(32) << QString::number(phaseTimes[i], 'f', 3) << "\n";
+  }
+
+  qint64 peakRSS = peakResidentSetSize();
+
+  report << QString("Peak RSS (MB)").leftJustified(32) << (peakRSS < 0 ? QString("n/a") : QString::number(peakRSS / 1048576.0, 'f', 1)) << "\n"
+         << QString("Provider steps").leftJustified(32) << providerSteps << "\n"
+         << QString("Observation steps").leftJustified(32) << observationSteps << "\n"
+         << QString("Provider steps/s").leftJustified(32) << QString::number(providerSteps / updateSeconds, 'f', 1) << "\n"
+         << QString("Observation steps/s").leftJustified(32) << QString::number(observationSteps / updateSeconds, 'f', 1) << "\n"
+         << QString("Geometry-steps/s").leftJustified(32) << QString::number(static_cast<double>(observationSteps) * geometries / updateSeconds, 'f', 1) << "\n";
+
+  report.flush();
+
+  return true;
+}
+
+qint64 ObjectiveBenchmark::peakResidentSetSize()
+{
+#if defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters;
+
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+  {
+    return static_cast<qint64>(counters.PeakWorkingSetSize);
+  }
+
+  return -1;
+#else
+  struct rusage usage;
+
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+#if defined(Q_OS_MAC)
+    return static_cast<qint64>(usage.ru_maxrss);
+#else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+  }
+
+  return -1;
+#endif
+}
+
+void ObjectiveBenchmark::initTestCase()
+{
+  QString error;
+
+  QVERIFY2(generate(error), qPrintable(error));
+  QVERIFY2(initialize(error), qPrintable(error));
+
+  link();
+
+  QVERIFY2(prepare(error), qPrintable(error));
+  QVERIFY(objectiveInput());
+}
+
+void ObjectiveBenchmark::cleanupTestCase()
+{
+  finish();
+}
+
+void ObjectiveBenchmark::applyData()
+{
+  ObjectiveInput *input = objectiveInput();
+  input->retrieveValuesFromProvider();
+
+  QVERIFY(input->m_statistics.size() > 0);
+
+  double count = input->m_statistics.statistics(0).count();
+  int iterations = 0;
+
+  QBENCHMARK
+  {
+    //An observation time is only accumulated once. Forgetting it makes every iteration apply and accumulate the values again.
+    input->m_accumulatedDateTimeIndex = -1;
+    input->applyData();
+    iterations++;
+  }
+
+  QCOMPARE(input->m_statistics.statistics(0).count(), count + iterations);
+}
+
+void ObjectiveBenchmark::setProvider()
+{
+  ObjectiveInput *input = objectiveInput();
+  SyntheticProviderOutput *output = m_provider->output();
+
+  QBENCHMARK
+  {
+    input->setProvider(output);
+  }
+}
+
+void ObjectiveBenchmark::providerGeometryIndex()
+{
+  ObjectiveInput *input = objectiveInput();
+  int matched = 0;
+
+  QBENCHMARK
+  {
+    ProviderGeometryIndex geometryIndex(m_provider->output());
+    matched = 0;
+
+    for(int i = 0; i < input->geometryCount(); i++)
+    {
+      if(geometryIndex.findGeometry(input->getGeometry(i)) >= 0)
+      {
+        matched++;
+      }
+    }
+  }
+
+  QCOMPARE(matched, input->geometryCount());
+}
+
+void ObjectiveBenchmark::statisticsKernel_data()
+{
+  QTest::addColumn<ObjectiveStatisticsArray::Kernel>("kernel");
+
+  QTest::newRow("Scalar") << ObjectiveStatisticsArray::Scalar;
+
+  if(ObjectiveStatisticsArray::isKernelSupported(ObjectiveStatisticsArray::AVX2))
+  {
+    QTest::newRow("AVX2") << ObjectiveStatisticsArray::AVX2;
+  }
+
+  if(ObjectiveStatisticsArray::isKernelSupported(ObjectiveStatisticsArray::AVX512))
+  {
+    QTest::newRow("AVX512") << ObjectiveStatisticsArray::AVX512;
+  }
+}
+
+void ObjectiveBenchmark::statisticsKernel()
+{
+  QFETCH(ObjectiveStatisticsArray::Kernel, kernel);
+
+  ObjectiveStatisticsArray statistics;
+  statistics.setKernel(kernel);
+  statistics.resize(m_options.geometries);
+
+  std::vector<double> observed(m_options.geometries), simulated(m_options.geometries);
+
+  for(int g = 0; g < m_options.geometries; g++)
+  {
+    observed[g] = SyntheticData::simulatedValue(g, 0.25);
+    simulated[g] = SyntheticData::simulatedValue(g, 0.5);
+  }
+
+  QBENCHMARK
+  {
+    statistics.add(observed.data(), simulated.data());
+  }
+
+  //The vector kernels have to reproduce the scalar kernel bit for bit.
+  ObjectiveStatisticsArray checked, reference;
+  checked.setKernel(kernel);
+  checked.resize(m_options.geometries);
+  reference.setKernel(ObjectiveStatisticsArray::Scalar);
+  reference.resize(m_options.geometries);
+
+  for(int t = 0; t < 24; t++)
+  {
+    for(int g = 0; g < m_options.geometries; g++)
+    {
+      observed[g] = SyntheticData::simulatedValue(g, t / 24.0);
+      simulated[g] = SyntheticData::simulatedValue(g, (t + 0.5) / 24.0);
+    }
+
+    checked.add(observed.data(), simulated.data());
+    reference.add(observed.data(), simulated.data());
+  }
+
+  std::vector<double> checkedMetrics(m_options.geometries), referenceMetrics(m_options.geometries);
+
+  for(int a = TSObjectiveFunctionComponent::NashSutcliff; a <= TSObjectiveFunctionComponent::RSquared; a++)
+  {
+    TSObjectiveFunctionComponent::Algorithm algorithm = static_cast<TSObjectiveFunctionComponent::Algorithm>(a);
+    checked.metrics(algorithm, checkedMetrics.data());
+    reference.metrics(algorithm, referenceMetrics.data());
+
+    QVERIFY2(!memcmp(checkedMetrics.data(), referenceMetrics.data(), sizeof(double) * checkedMetrics.size()),
+             qPrintable(TSObjectiveFunctionComponent::algorithmName(algorithm)));
+  }
+}
+
+void ObjectiveBenchmark::metrics_data()
+{
+  QTest::addColumn<TSObjectiveFunctionComponent::Algorithm>("algorithm");
+
+  for(int i = TSObjectiveFunctionComponent::NashSutcliff; i <= TSObjectiveFunctionComponent::RSquared; i++)
+  {
+    TSObjectiveFunctionComponent::Algorithm algorithm = static_cast<TSObjectiveFunctionComponent::Algorithm>(i);
+    QTest::newRow(qPrintable(TSObjectiveFunctionComponent::algorithmName(algorithm))) << algorithm;
+  }
+}
+
+void ObjectiveBenchmark::metrics()
+{
+  QFETCH(TSObjectiveFunctionComponent::Algorithm, algorithm);
+
+  ObjectiveStatisticsArray statistics;
+  statistics.resize(m_options.geometries);
+
+  std::vector<double> observed(m_options.geometries), simulated(m_options.geometries), values(m_options.geometries);
+
+  for(int t = 0; t < 24; t++)
+  {
+    for(int g = 0; g < m_options.geometries; g++)
+    {
+      observed[g] = SyntheticData::simulatedValue(g, t / 24.0);
+      simulated[g] = SyntheticData::simulatedValue(g, (t + 0.5) / 24.0);
+    }
+
+    statistics.add(observed.data(), simulated.data());
+    statistics.addLogarithmic(observed.data(), simulated.data());
+  }
+
+  QBENCHMARK
+  {
+    statistics.metrics(algorithm, values.data());
+  }
+}
+
+void ObjectiveBenchmark::allReduce()
+{
+  int rank, size;
+
+  if(!mpiWorld(rank, size))
+    QSKIP("Requires a build with USE_MPI started with mpirun on more than one rank");
+
+  int geometries = m_options.geometries;
+  int timeSteps = 24 * size;
+
+  ObjectiveStatisticsArray distributed, serial;
+  distributed.resize(geometries);
+  serial.resize(geometries);
+
+  std::vector<double> observed(geometries), simulated(geometries);
+
+  //Every rank accumulates every size-th time step and also all time steps for reference.
+  for(int t = 0; t < timeSteps; t++)
+  {
+    for(int g = 0; g < geometries; g++)
+    {
+      observed[g] = SyntheticData::simulatedValue(g, t / 24.0);
+      simulated[g] = SyntheticData::simulatedValue(g, (t + 0.5) / 24.0);
+    }
+
+    serial.add(observed.data(), simulated.data());
+    serial.addLogarithmic(observed.data(), simulated.data());
+
+    if(t % size == rank)
+    {
+      distributed.add(observed.data(), simulated.data());
+      distributed.addLogarithmic(observed.data(), simulated.data());
+    }
+  }
+
+  bool reduced = distributed.allReduce();
+
+  int algorithmCount = TSObjectiveFunctionComponent::RSquared + 1;
+  std::vector<double> distributedMetrics(static_cast<size_t>(algorithmCount) * geometries), serialMetrics(distributedMetrics.size());
+
+  for(int a = 0; a < algorithmCount; a++)
+  {
+    TSObjectiveFunctionComponent::Algorithm algorithm = static_cast<TSObjectiveFunctionComponent::Algorithm>(a);
+    distributed.metrics(algorithm, distributedMetrics.data() + static_cast<size_t>(a) * geometries);
+    serial.metrics(algorithm, serialMetrics.data() + static_cast<size_t>(a) * geometries);
+  }
+
+  std::vector<double> rootMetrics(distributedMetrics);
+
+#ifdef USE_MPI
+  //Collective calls complete on every rank before any check can return early.
+  MPI_Bcast(rootMetrics.data(), static_cast<int>(rootMetrics.size()), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+#endif
+
+  QVERIFY(reduced);
+  QVERIFY(!memcmp(rootMetrics.data(), distributedMetrics.data(), sizeof(double) * distributedMetrics.size()));
+
+  for(size_t i = 0; i < serialMetrics.size(); i++)
+  {
+    QVERIFY2(std::abs(distributedMetrics[i] - serialMetrics[i]) <= 1.0e-9 * std::max(1.0, std::abs(serialMetrics[i])),
+             qPrintable(QString("Metric %1: %2 != %3").arg(i).arg(distributedMetrics[i], 0, 'g', 17).arg(serialMetrics[i], 0, 'g', 17)));
+  }
+}
+
+void ObjectiveBenchmark::ensembleOutput()
+{
+  int rank, size;
+
+  if(!mpiWorld(rank, size))
+    QSKIP("Requires a build with USE_MPI started with mpirun on more than one rank");
+
+  QDir directory(m_directory->path());
+  QString inputFile = directory.absoluteFilePath("ensemble.inp");
+  QString outputFile = directory.absoluteFilePath("ensemble.csv");
+
+  QFile sourceInput(m_inputFile), ensembleInput(inputFile);
+  QVERIFY(sourceInput.open(QIODevice::ReadOnly | QIODevice::Text));
+  QVERIFY(ensembleInput.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text));
+  ensembleInput.write(sourceInput.readAll().replace("[OPTIONS]\n", "[OPTIONS]\nMPI_MODE ENSEMBLE\n"));
+  ensembleInput.close();
+
+  TSObjectiveFunctionComponentInfo componentInfo;
+  SyntheticProviderComponentInfo providerInfo;
+
+  TSObjectiveFunctionComponent *parent = dynamic_cast<TSObjectiveFunctionComponent*>(componentInfo.createComponentInstance());
+
+  for(IArgument *argument : parent->arguments())
+  {
+    IdBasedArgumentString *inputFilesArgument = dynamic_cast<IdBasedArgumentString*>(argument);
+
+    if(inputFilesArgument && inputFilesArgument->id() == "InputFiles")
+    {
+      (*inputFilesArgument)["Input File"] = inputFile;
+      (*inputFilesArgument)["Output CSV File"] = outputFile;
+    }
+  }
+
+  parent->initialize();
+
+  bool membersDone = parent->status() == IModelComponent::Initialized;
+
+  //Ranks run different numbers of members, so members write a different number of rows on every rank.
+  for(int m = 0; m <= rank && membersDone; m++)
+  {
+    TSObjectiveFunctionComponent *member = dynamic_cast<TSObjectiveFunctionComponent*>(parent->clone());
+    SyntheticProviderComponent *provider = dynamic_cast<SyntheticProviderComponent*>(providerInfo.createComponentInstance());
+    provider->setSyntheticData(m_options, m_geometryFile);
+    provider->initialize();
+
+    linkComponents(member, provider);
+
+    provider->prepare();
+    member->prepare();
+
+    while (member->status() == IModelComponent::Updated)
+    {
+      member->update();
+    }
+
+    membersDone = member->status() == IModelComponent::Done;
+
+    unlinkComponents(member, provider);
+
+    member->finish();
+    provider->finish();
+    delete provider;
+  }
+
+  parent->finish();
+  delete parent;
+
+  QVERIFY(membersDone);
+
+  if(rank == 0)
+  {
+    QFile output(outputFile);
+    QVERIFY(output.open(QIODevice::ReadOnly | QIODevice::Text));
+
+    int rows = 0;
+
+    while (!output.atEnd())
+    {
+      if(!output.readLine().trimmed().isEmpty())
+      {
+        rows++;
+      }
+    }
+
+    QCOMPARE(rows - 1, size * (size + 1) / 2);
+  }
+}
+
+void ObjectiveBenchmark::metricLowerBound()
+{
+  TSObjectiveFunctionComponentInfo componentInfo;
+  SyntheticProviderComponentInfo providerInfo;
+
+  TSObjectiveFunctionComponent *component = dynamic_cast<TSObjectiveFunctionComponent*>(componentInfo.createComponentInstance());
+  SyntheticProviderComponent *provider = dynamic_cast<SyntheticProviderComponent*>(providerInfo.createComponentInstance());
+
+  for(IArgument *argument : component->arguments())
+  {
+    IdBasedArgumentString *inputFilesArgument = dynamic_cast<IdBasedArgumentString*>(argument);
+
+    if(inputFilesArgument && inputFilesArgument->id() == "InputFiles")
+    {
+      (*inputFilesArgument)["Input File"] = m_inputFile;
+      (*inputFilesArgument)["Output CSV File"] = QDir(m_directory->path()).absoluteFilePath("bounds.csv");
+    }
+  }
+
+  provider->setSyntheticData(m_options, m_geometryFile);
+  provider->initialize();
+  component->initialize();
+
+  linkComponents(component, provider);
+
+  provider->prepare();
+  component->prepare();
+
+  const TSObjectiveFunctionComponent::Algorithm algorithms[] = {TSObjectiveFunctionComponent::NashSutcliff,
+                                                                TSObjectiveFunctionComponent::RMSE,
+                                                                TSObjectiveFunctionComponent::MAE};
+  const int algorithmCount = 3;
+
+  std::vector<double> bounds[algorithmCount];
+  double finalMetrics[algorithmCount] = {0.0};
+
+  ObjectiveInput *input = component->inputs().size() ? dynamic_cast<ObjectiveInput*>(component->inputs().first()) : nullptr;
+  bool done = false;
+
+  if(input && component->status() == IModelComponent::Updated)
+  {
+    input->initializeMetricBounds();
+
+    while (component->status() == IModelComponent::Updated)
+    {
+      component->update();
+
+      for(int a = 0; a < algorithmCount; a++)
+      {
+        bounds[a].push_back(input->metricLowerBound(algorithms[a]));
+      }
+    }
+
+    done = component->status() == IModelComponent::Done;
+
+    std::vector<double> values(input->geometryCount());
+
+    for(int a = 0; a < algorithmCount; a++)
+    {
+      input->metrics(algorithms[a], values.data());
+
+      for(double value : values)
+      {
+        finalMetrics[a] += value / values.size();
+      }
+    }
+  }
+
+  unlinkComponents(component, provider);
+
+  component->finish();
+  provider->finish();
+  delete component;
+  delete provider;
+
+  QVERIFY(input);
+  QVERIFY(done);
+
+  for(int a = 0; a < algorithmCount; a++)
+  {
+    QVERIFY(!bounds[a].empty());
+
+    for(size_t t = 0; t < bounds[a].size(); t++)
+    {
+      QVERIFY2(bounds[a][t] <= finalMetrics[a] + 1.0e-9 * std::max(1.0, std::abs(finalMetrics[a])),
+               qPrintable(QString("%1 step %2: bound %3 > metric %4").arg(TSObjectiveFunctionComponent::algorithmName(algorithms[a]))
+                          .arg(t).arg(bounds[a][t], 0, 'g', 17).arg(finalMetrics[a], 0, 'g', 17)));
+    }
+  }
+}
+
+bool ObjectiveBenchmark::generate(QString &error)
+{
+  delete m_directory;
+  m_directory = new QTemporaryDir();
+
+  if(!m_directory->isValid())
+  {
+    error = "Unable to create temporary directory";
+    return false;
+  }
+
+  return SyntheticData::generate(m_options, m_directory->path(), m_inputFile, m_geometryFile, error);
+}
+
+bool ObjectiveBenchmark::initialize(QString &error)
+{
+  finish();
+
+  m_componentInfo = new TSObjectiveFunctionComponentInfo();
+  m_providerInfo = new SyntheticProviderComponentInfo();
+
+  m_component = dynamic_cast<TSObjectiveFunctionComponent*>(m_componentInfo->createComponentInstance());
+  m_provider = dynamic_cast<SyntheticProviderComponent*>(m_providerInfo->createComponentInstance());
+
+  for(IArgument *argument : m_component->arguments())
+  {
+    IdBasedArgumentString *inputFilesArgument = dynamic_cast<IdBasedArgumentString*>(argument);
+
+    if(inputFilesArgument && inputFilesArgument->id() == "InputFiles")
+    {
+      (*inputFilesArgument)["Input File"] = m_inputFile;
+      (*inputFilesArgument)["Output CSV File"] = QDir(m_directory->path()).absoluteFilePath("objectives.csv");
+    }
+  }
+
+  m_provider->setSyntheticData(m_options, m_geometryFile);
+
+  m_provider->initialize();
+  m_component->initialize();
+
+  if(m_provider->status() != IModelComponent::Initialized)
+  {
+    error = "Synthetic provider component failed to initialize";
+    return false;
+  }
+
+  if(m_component->status() != IModelComponent::Initialized)
+  {
+    error = "Objective function component failed to initialize";
+    return false;
+  }
+
+  return true;
+}
+
+void ObjectiveBenchmark::link()
+{
+  linkComponents(m_component, m_provider);
+}
+
+bool ObjectiveBenchmark::prepare(QString &error)
+{
+  m_provider->prepare();
+  m_component->prepare();
+
+  if(m_provider->status() != IModelComponent::Updated || m_component->status() != IModelComponent::Updated)
+  {
+    error = "Components failed to prepare";
+    return false;
+  }
+
+  return true;
+}
+
+void ObjectiveBenchmark::finish()
+{
+  if(m_component && m_provider)
+  {
+    unlinkComponents(m_component, m_provider);
+  }
+
+  if(m_component)
+  {
+    m_component->finish();
+    delete m_component;
+    m_component = nullptr;
+  }
+
+  if(m_provider)
+  {
+    m_provider->finish();
+    delete m_provider;
+    m_provider = nullptr;
+  }
+
+  delete m_componentInfo;
+  m_componentInfo = nullptr;
+
+  delete m_providerInfo;
+  m_providerInfo = nullptr;
+}
+
+ObjectiveInput *ObjectiveBenchmark::objectiveInput() const
+{
+  if(m_component && m_component->inputs().size())
+  {
+    return dynamic_cast<ObjectiveInput*>(m_component->inputs().first());
+  }
+
+  return nullptr;
+}
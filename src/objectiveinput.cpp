@@ -1,24 +1,44 @@
 #include "stdafx.h"
 #include "objectiveinput.h"
-#include "temporal/timeseries.h"
+#include "observationseries.h"
 #include "spatial/geometry.h"
 #include "temporal/timedata.h"
 #include "core/valuedefinition.h"
+#include "observationindex.h"
+#include "providergeometryindex.h"
+#include "valuearraydata.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 using namespace HydroCouple::Spatial;
 
 
 ObjectiveInput::ObjectiveInput(const QString &id,
-                               TimeSeries *timeSeries,
+                               ObservationSeries *timeSeries,
                                Dimension *timeDimension,
                                Dimension *geometryDimension,
                                HydroCouple::Spatial::IGeometry::GeometryType geometryType,
                                Quantity *valueDefinition,
                                TSObjectiveFunctionComponent *component)
   : TimeGeometryInputDouble(id, geometryType, timeDimension, geometryDimension, valueDefinition, component),
+    m_retainHistory(true),
+    m_accumulateLogarithmicStatistics(false),
+    m_batchUpdate(false),
+    m_currentDateTime(0.0),
+    m_currentSlotDateTime(nullptr),
+    m_timeTolerance(0.0),
     m_startDateTimeIndex(0),
     m_endDateTimeIndex(0),
     m_nextDateTimeIndex(0),
+    m_accumulatedDateTimeIndex(-1),
+    m_currentAlignedIndex(0),
+    m_alignedDateTimeIndexes(new std::vector<int>()),
+    m_timeGeometryProvider(nullptr),
+    m_valueArrayProvider(nullptr),
+    m_contiguousProviderOffset(-1),
     m_timeSeries(timeSeries),
     m_objectiveFunctionComponent(component)
 {
@@ -35,33 +55,66 @@ void ObjectiveInput::initialize()
   double startTime = m_objectiveFunctionComponent->timeHorizon()->julianDay();
   double endTime = startTime + m_objectiveFunctionComponent->timeHorizon()->duration();
 
-  for(int i = 0 ; i < m_timeSeries->numRows() - 1; i++)
+  m_accumulatedDateTimeIndex = -1;
+  m_statistics.resize(geometryCount());
+  m_observedValues.assign(geometryCount(), 0.0);
+  m_simulatedValues.assign(geometryCount(), 0.0);
+
+  //Observation rows within the horizon are located with a binary search and merged once. Rows that fall
+  //within the tolerance of the previously accepted row (duplicates or out of order records) are skipped, so
+  //the update loop only walks pre-matched rows and never compares dates. The rows are shared with clones
+  //that read the same observation file over the same horizon.
+  m_alignedDateTimeIndexes = ObservationIndex::alignedRows(m_timeSeriesKey, m_timeSeries, startTime, endTime, m_timeTolerance);
+
+  m_currentAlignedIndex = 0;
+
+  if(m_alignedDateTimeIndexes->size())
+  {
+    m_startDateTimeIndex = m_alignedDateTimeIndexes->front();
+    m_endDateTimeIndex = m_alignedDateTimeIndexes->back();
+    m_nextDateTimeIndex = m_startDateTimeIndex;
+    m_currentDateTime = m_timeSeries->dateTime(m_startDateTimeIndex);
+  }
+  else
   {
-    double dateTime = m_timeSeries->dateTime(i);
+    m_currentDateTime = endTime + 0.000001;
+  }
 
-    if(dateTime >= startTime)
-    {
-      m_startDateTimeIndex = i;
-      m_nextDateTimeIndex = i;
-      m_currentDateTime = dateTime;
+  m_currentSlotDateTime = new SDKTemporal::DateTime(m_currentDateTime, nullptr);
+  addTime(m_currentSlotDateTime);
+}
 
-      addTime(new SDKTemporal::DateTime(m_currentDateTime, nullptr));
+void ObjectiveInput::reset()
+{
+  m_statistics.reset();
+  m_accumulatedDateTimeIndex = -1;
+  m_currentAlignedIndex = 0;
 
-      for(int j = i; j < m_timeSeries->numRows(); j++)
-      {
-        dateTime = m_timeSeries->dateTime(j);
+  if(m_alignedDateTimeIndexes->size())
+  {
+    m_nextDateTimeIndex = m_startDateTimeIndex;
+    m_currentDateTime = m_timeSeries->dateTime(m_startDateTimeIndex);
+  }
+  else
+  {
+    m_currentDateTime = m_objectiveFunctionComponent->timeHorizon()->julianDay() + m_objectiveFunctionComponent->timeHorizon()->duration() + 0.000001;
+  }
 
-        if(dateTime <= endTime)
-        {
-          m_endDateTimeIndex = j;
-        }
-        else
-        {
-          break;
-        }
-      }
-      break;
-    }
+  //Only the first slot is kept so that providers are queried from the start of the horizon again.
+  while (timeCount() > 1)
+  {
+    removeTime(dynamic_cast<SDKTemporal::DateTime*>(time(timeCount() - 1)));
+  }
+
+  m_currentSlotDateTime = timeCount() ? dynamic_cast<SDKTemporal::DateTime*>(time(0)) : nullptr;
+
+  if(m_currentSlotDateTime)
+  {
+    m_currentSlotDateTime->setJulianDay(m_currentDateTime);
+  }
+  else
+  {
+    updateCurrentSlot();
   }
 }
 
@@ -72,7 +125,7 @@ int ObjectiveInput::startDateTimeIndex() const
 
 int ObjectiveInput::recordLength() const
 {
-  return m_endDateTimeIndex - m_startDateTimeIndex + 1;
+  return static_cast<int>(m_alignedDateTimeIndexes->size());
 }
 
 double ObjectiveInput::currentDateTime() const
@@ -84,53 +137,142 @@ void ObjectiveInput::moveToNextDateTime()
 {
   if(provider()->modelComponent()->status() == HydroCouple::IModelComponent::ComponentStatus::Updated)
   {
-    //unnecessary fix later
-    int nextIndex = m_nextDateTimeIndex + 1;
+    int nextIndex = m_currentAlignedIndex + 1;
 
-    if( nextIndex <= m_endDateTimeIndex &&
-        nextIndex < m_timeSeries->numRows())
+    if(nextIndex < static_cast<int>(m_alignedDateTimeIndexes->size()))
     {
-      m_nextDateTimeIndex++;
+      m_currentAlignedIndex = nextIndex;
+      m_nextDateTimeIndex = (*m_alignedDateTimeIndexes)[nextIndex];
       m_currentDateTime = m_timeSeries->dateTime(m_nextDateTimeIndex);
     }
     else
     {
+      m_currentAlignedIndex = static_cast<int>(m_alignedDateTimeIndexes->size());
       m_currentDateTime = m_objectiveFunctionComponent->timeHorizon()->julianDay() + m_objectiveFunctionComponent->timeHorizon()->duration() + 0.000001;
     }
   }
   else
   {
+    m_currentAlignedIndex = static_cast<int>(m_alignedDateTimeIndexes->size());
     m_currentDateTime = m_objectiveFunctionComponent->timeHorizon()->julianDay() + m_objectiveFunctionComponent->timeHorizon()->duration() + 0.000001;
   }
 }
 
+QString ObjectiveInput::timeSeriesKey() const
+{
+  return m_timeSeriesKey;
+}
+
+void ObjectiveInput::setTimeSeriesKey(const QString &timeSeriesKey)
+{
+  m_timeSeriesKey = timeSeriesKey;
+}
+
+double ObjectiveInput::timeTolerance() const
+{
+  return m_timeTolerance;
+}
+
+void ObjectiveInput::setTimeTolerance(double timeTolerance)
+{
+  m_timeTolerance = timeTolerance;
+}
+
+bool ObjectiveInput::retainHistory() const
+{
+  return m_retainHistory;
+}
+
+void ObjectiveInput::setRetainHistory(bool retainHistory)
+{
+  m_retainHistory = retainHistory;
+}
+
+bool ObjectiveInput::accumulateLogarithmicStatistics() const
+{
+  return m_accumulateLogarithmicStatistics;
+}
+
+void ObjectiveInput::setAccumulateLogarithmicStatistics(bool accumulate)
+{
+  m_accumulateLogarithmicStatistics = accumulate;
+}
+
 bool ObjectiveInput::setProvider(HydroCouple::IOutput *provider)
 {
-  m_geometryMapping.clear();
+  //The index of a provider that is let go of is dropped, since another provider may later be allocated at its address.
+  if(m_timeGeometryProvider && m_timeGeometryProvider != dynamic_cast<ITimeGeometryComponentDataItem*>(provider))
+  {
+    m_objectiveFunctionComponent->releaseProviderGeometryIndex(m_timeGeometryProvider);
+  }
+
+  m_timeGeometryProvider = nullptr;
+  m_valueArrayProvider = nullptr;
+  m_contiguousProviderOffset = -1;
+  m_mappedGeometries.clear();
+  m_mappedProviderGeometries.clear();
+  m_unmappedGeometries.clear();
 
   if(AbstractInput::setProvider(provider) && provider)
   {
     ITimeGeometryComponentDataItem *timeGeometryDataItem = dynamic_cast<ITimeGeometryComponentDataItem*>(provider);
+    m_timeGeometryProvider = timeGeometryDataItem;
+    m_valueArrayProvider = dynamic_cast<ITimeGeometryValueArray*>(provider);
 
     if(timeGeometryDataItem->geometryCount())
     {
+      QSharedPointer<ProviderGeometryIndex> geometryIndex = m_objectiveFunctionComponent->providerGeometryIndex(timeGeometryDataItem);
+      std::vector<std::pair<int,int>> mapping;
+
       for(int i = 0; i < geometryCount() ; i++)
       {
-        HCGeometry *geometry = getGeometry(i);
+        int j = geometryIndex->findGeometry(getGeometry(i));
 
-        for(int j = 0; j < timeGeometryDataItem->geometryCount() ; j++)
+        if(j >= 0)
         {
-          IGeometry *providerGeometry = timeGeometryDataItem->geometry(j);
-
-          if(equalsGeometry(geometry, providerGeometry))
-          {
-            m_geometryMapping[i] = j;
-            break;
-          }
+          mapping.push_back(std::make_pair(j, i));
         }
       }
+
+      //Mapped geometries are ordered by provider geometry index so that provider values are read in
+      //ascending memory order.
+      std::sort(mapping.begin(), mapping.end());
+
+      m_mappedProviderGeometries.reserve(mapping.size());
+      m_mappedGeometries.reserve(mapping.size());
+
+      for(const std::pair<int,int> &map : mapping)
+      {
+        m_mappedProviderGeometries.push_back(map.first);
+        m_mappedGeometries.push_back(map.second);
+      }
+
+      //A run of consecutive provider geometries is copied from a contiguous slice in one go.
+      if(m_mappedProviderGeometries.size() &&
+         m_mappedProviderGeometries.back() - m_mappedProviderGeometries.front() + 1 == static_cast<int>(m_mappedProviderGeometries.size()))
+      {
+        m_contiguousProviderOffset = m_mappedProviderGeometries.front();
+      }
+    }
+
+    std::vector<bool> mapped(geometryCount(), false);
+
+    for(int i : m_mappedGeometries)
+    {
+      mapped[i] = true;
+    }
+
+    for(int i = 0; i < geometryCount(); i++)
+    {
+      if(!mapped[i])
+      {
+        m_unmappedGeometries.push_back(i);
+      }
     }
 
+    m_providerCurrentValues.assign(m_mappedGeometries.size(), 0.0);
+    m_providerPreviousValues.assign(m_mappedGeometries.size(), 0.0);
+
     return true;
   }
 
@@ -157,7 +299,14 @@ bool ObjectiveInput::canConsume(HydroCouple::IOutput *provider, QString &message
 
 void ObjectiveInput::retrieveValuesFromProvider()
 {
+  if(prepareRetrieval())
+  {
+    provider()->updateValues(this);
+  }
+}
 
+bool ObjectiveInput::prepareRetrieval()
+{
   if(provider()->modelComponent()->status() == HydroCouple::IModelComponent::ComponentStatus::Updated)
   {
     int numTimes = timeCount();
@@ -165,108 +314,308 @@ void ObjectiveInput::retrieveValuesFromProvider()
 
     if(m_currentDateTime != lastDateTime)
     {
-      addTime(new SDKTemporal::DateTime(m_currentDateTime, nullptr));
+      updateCurrentSlot();
     }
 
-    provider()->updateValues(this);
+    return true;
   }
+
+  return false;
 }
 
 void ObjectiveInput::applyData()
 {
+  ITimeGeometryComponentDataItem *timeGeometryDataItem = m_timeGeometryProvider;
 
-  //  double currentTime = m_objectiveFunctionComponent->timeHorizon()->julianDay();
-  ITimeGeometryComponentDataItem *timeGeometryDataItem = nullptr;
-
-  if((timeGeometryDataItem = dynamic_cast<ITimeGeometryComponentDataItem*>(provider())))
+  if(timeGeometryDataItem)
   {
-    int currentTimeIndex = timeGeometryDataItem->timeCount() - 1;
-    int previousTimeIndex = std::max(0 , timeGeometryDataItem->timeCount() - 2);
-
-    double providerCurrentTime = timeGeometryDataItem->time(currentTimeIndex)->julianDay();
-    double providerPreviousTime = timeGeometryDataItem->time(previousTimeIndex)->julianDay();
+    applyProviderValues();
+    accumulateStatistics();
 
-    if(m_currentDateTime >=  providerPreviousTime && m_currentDateTime <= providerCurrentTime)
+    if(m_batchUpdate)
     {
-      double factor = 0.0;
+      //Consume every remaining observation time the provider has already stepped over. The input is left on
+      //the last consumed observation so that moveToNextDateTime advances past it as in the single step mode.
+      double providerLastTime = timeGeometryDataItem->time(timeGeometryDataItem->timeCount() - 1)->julianDay();
+      const std::vector<int> &alignedRows = *m_alignedDateTimeIndexes;
 
-      if(providerCurrentTime > providerPreviousTime)
+      while (m_currentAlignedIndex + 1 < static_cast<int>(alignedRows.size()) &&
+             m_timeSeries->dateTime(alignedRows[m_currentAlignedIndex + 1]) <= providerLastTime + m_timeTolerance)
       {
-        double denom = providerCurrentTime - providerPreviousTime;
-        double numer = m_currentDateTime - providerPreviousTime;
-        factor = numer / denom;
-      }
+        m_currentAlignedIndex++;
+        m_nextDateTimeIndex = alignedRows[m_currentAlignedIndex];
+        m_currentDateTime = m_timeSeries->dateTime(m_nextDateTimeIndex);
 
-      for(auto it : m_geometryMapping)
-      {
-        double value1 = 0;
-        double value2 = 0;
-
-        timeGeometryDataItem->getValue(currentTimeIndex,it.second, &value1);
-        timeGeometryDataItem->getValue(previousTimeIndex,it.second, &value2);
-
-        double interpVal = value2 + factor *(value1 - value2);
-        setValue(timeCount() -1, it.first, &interpVal);
-      }
-    }
-    else
-    {
-      for(auto it : m_geometryMapping)
-      {
-        double value = 0;
-        timeGeometryDataItem->getValue(currentTimeIndex,it.second, &value);
-        setValue(timeCount() -1, it.first, &value);
+        updateCurrentSlot();
+        applyProviderValues();
+        accumulateStatistics();
       }
     }
   }
 }
 
-TimeSeries *ObjectiveInput::timeSeries() const
+bool ObjectiveInput::batchUpdate() const
+{
+  return m_batchUpdate;
+}
+
+void ObjectiveInput::setBatchUpdate(bool batchUpdate)
+{
+  m_batchUpdate = batchUpdate;
+}
+
+ObservationSeries *ObjectiveInput::timeSeries() const
 {
   return m_timeSeries;
 }
 
-bool ObjectiveInput::equalsGeometry(IGeometry *geom1, IGeometry *geom2, double epsilon)
+ObjectiveStatistics ObjectiveInput::statistics(int geometryIndex) const
+{
+  return m_statistics.statistics(geometryIndex);
+}
+
+void ObjectiveInput::metrics(TSObjectiveFunctionComponent::Algorithm algorithm, double *values) const
+{
+  m_statistics.metrics(algorithm, values);
+}
+
+void ObjectiveInput::initializeMetricBounds()
 {
-  if(geom1->geometryType() == geom2->geometryType())
+  ObjectiveStatisticsArray horizonStatistics;
+  horizonStatistics.setKernel(m_statistics.kernel());
+  horizonStatistics.resize(geometryCount());
+
+  std::vector<double> observedValues(geometryCount(), 0.0);
+
+  for(int row : *m_alignedDateTimeIndexes)
   {
-    switch (geom1->geometryType())
+    for(int g = 0; g < geometryCount(); g++)
     {
-      case IGeometry::LineString:
-      case IGeometry::LineStringM:
-      case IGeometry::LineStringZ:
-      case IGeometry::LineStringZM:
-        {
-          ILineString *lineString1 = dynamic_cast<ILineString*>(geom1);
-          ILineString *lineString2 = dynamic_cast<ILineString*>(geom2);
+      observedValues[g] = m_timeSeries->value(row, g);
+    }
 
-          if(lineString1 && lineString2 && lineString1->pointCount() == lineString2->pointCount())
-          {
-            for(int i = 0 ; i < lineString1->pointCount(); i++)
-            {
-              IPoint *p1 = lineString1->point(i);
-              IPoint *p2 = lineString2->point(i);
+    horizonStatistics.add(observedValues.data(), observedValues.data());
+  }
+
+  m_horizonObservedDeviations.resize(geometryCount());
+
+  for(int g = 0; g < geometryCount(); g++)
+  {
+    m_horizonObservedDeviations[g] = horizonStatistics.statistics(g).observedSumSquaredDeviations();
+  }
+}
+
+double ObjectiveInput::metricLowerBound(TSObjectiveFunctionComponent::Algorithm algorithm) const
+{
+  int geometries = m_statistics.size();
+  double recordCount = recordLength();
+
+  if(geometries == 0 || recordCount == 0)
+    return 0.0;
 
-              double dx = p1->x() - p2->x();
-              double dy = p1->y() - p2->y();
+  double bound = 0.0;
 
-              double dist = sqrt(dx * dx + dy * dy);
+  for(int g = 0; g < geometries; g++)
+  {
+    ObjectiveStatistics statistics = m_statistics.statistics(g);
 
-              if(dist < epsilon)
-              {
-                return true;
-              }
-            }
+    //Bounds follow the definitions of ObjectiveStatistics::metric.
+    switch (algorithm)
+    {
+      case TSObjectiveFunctionComponent::NashSutcliff:
+        {
+          if(g < static_cast<int>(m_horizonObservedDeviations.size()) && m_horizonObservedDeviations[g] > 0.0)
+          {
+            bound += statistics.sumSquaredErrors() / m_horizonObservedDeviations[g];
           }
         }
         break;
-      default:
+      case TSObjectiveFunctionComponent::RMSE:
         {
-          return geom1->equals(geom2);
+          bound += sqrt(statistics.sumSquaredErrors() / recordCount);
         }
         break;
+      case TSObjectiveFunctionComponent::MAE:
+        {
+          bound += sqrt(statistics.sumAbsoluteErrors() / recordCount);
+        }
+        break;
+      default:
+        break;
     }
   }
 
-  return false;
+  return bound / geometries;
+}
+
+bool ObjectiveInput::reduceStatistics()
+{
+  for(int g : m_unmappedGeometries)
+  {
+    m_statistics.clear(g);
+  }
+
+  return m_statistics.allReduce();
+}
+
+ObjectiveStatisticsArray::Kernel ObjectiveInput::statisticsKernel() const
+{
+  return m_statistics.kernel();
+}
+
+void ObjectiveInput::setStatisticsKernel(ObjectiveStatisticsArray::Kernel kernel)
+{
+  m_statistics.setKernel(kernel);
+}
+
+void ObjectiveInput::accumulateStatistics()
+{
+  if(m_currentAlignedIndex < static_cast<int>(m_alignedDateTimeIndexes->size()) &&
+     m_nextDateTimeIndex != m_accumulatedDateTimeIndex)
+  {
+    int currentTimeIndex = timeCount() - 1;
+
+    //Mapped simulated values were stored by applyProviderValues. Only geometries without a provider
+    //geometry are read from the time slot.
+    for(int g : m_unmappedGeometries)
+    {
+      getValue(currentTimeIndex, g, &m_simulatedValues[g]);
+    }
+
+    for(int g = 0; g < m_statistics.size(); g++)
+    {
+      m_observedValues[g] = m_timeSeries->value(m_nextDateTimeIndex, g);
+    }
+
+    m_statistics.add(m_observedValues.data(), m_simulatedValues.data());
+
+    if(m_accumulateLogarithmicStatistics)
+    {
+      m_statistics.addLogarithmic(m_observedValues.data(), m_simulatedValues.data());
+    }
+
+    m_accumulatedDateTimeIndex = m_nextDateTimeIndex;
+  }
+}
+
+void ObjectiveInput::updateCurrentSlot()
+{
+  if(m_retainHistory || !m_currentSlotDateTime)
+  {
+    m_currentSlotDateTime = new SDKTemporal::DateTime(m_currentDateTime, nullptr);
+    addTime(m_currentSlotDateTime);
+  }
+  else
+  {
+    m_currentSlotDateTime->setJulianDay(m_currentDateTime);
+  }
+}
+
+void ObjectiveInput::applyProviderValues()
+{
+  ITimeGeometryComponentDataItem *timeGeometryDataItem = m_timeGeometryProvider;
+
+  int providerTimeCount = timeGeometryDataItem->timeCount();
+  int currentTimeIndex = providerTimeCount - 1;
+  int previousTimeIndex = std::max(0 , providerTimeCount - 2);
+
+  double providerCurrentTime = timeGeometryDataItem->time(currentTimeIndex)->julianDay();
+  double providerPreviousTime = timeGeometryDataItem->time(previousTimeIndex)->julianDay();
+
+  //Most times fall within the provider's last interval. Otherwise, search its time buffer for the enclosing interval.
+  if(previousTimeIndex > 0 && m_currentDateTime < providerPreviousTime - m_timeTolerance)
+  {
+    int lower = 0;
+    int upper = previousTimeIndex;
+
+    while (upper - lower > 1)
+    {
+      int middle = (lower + upper) / 2;
+
+      if(timeGeometryDataItem->time(middle)->julianDay() <= m_currentDateTime)
+        lower = middle;
+      else
+        upper = middle;
+    }
+
+    previousTimeIndex = lower;
+    currentTimeIndex = upper;
+    providerCurrentTime = timeGeometryDataItem->time(currentTimeIndex)->julianDay();
+    providerPreviousTime = timeGeometryDataItem->time(previousTimeIndex)->julianDay();
+  }
+
+  int slotIndex = timeCount() - 1;
+  size_t mappedCount = m_mappedGeometries.size();
+
+  if(m_currentDateTime >= providerPreviousTime - m_timeTolerance &&
+     m_currentDateTime <= providerCurrentTime + m_timeTolerance)
+  {
+    double factor = 0.0;
+
+    if(providerCurrentTime > providerPreviousTime)
+    {
+      double denom = providerCurrentTime - providerPreviousTime;
+      double numer = m_currentDateTime - providerPreviousTime;
+      factor = std::min(1.0, std::max(0.0, numer / denom));
+    }
+
+    readProviderValues(currentTimeIndex, m_providerCurrentValues.data());
+    readProviderValues(previousTimeIndex, m_providerPreviousValues.data());
+
+    int interpolatedCount = static_cast<int>(mappedCount);
+    double *currentValues = m_providerCurrentValues.data();
+    const double *previousValues = m_providerPreviousValues.data();
+
+#ifdef USE_OPENMP
+#pragma omp parallel for if(interpolatedCount >= ObjectiveStatisticsArray::parallelThreshold())
+#endif
+    for(int k = 0; k < interpolatedCount; k++)
+    {
+      double value1 = currentValues[k];
+      double value2 = previousValues[k];
+      currentValues[k] = value2 + factor *(value1 - value2);
+    }
+  }
+  else
+  {
+    int nearestTimeIndex = m_currentDateTime < providerPreviousTime ? previousTimeIndex : currentTimeIndex;
+    readProviderValues(nearestTimeIndex, m_providerCurrentValues.data());
+  }
+
+  //Simulated values are kept contiguous for the statistics kernels so they do not have to be read back.
+  for(size_t k = 0; k < mappedCount; k++)
+  {
+    int g = m_mappedGeometries[k];
+    m_simulatedValues[g] = m_providerCurrentValues[k];
+    setValue(slotIndex, g, &m_providerCurrentValues[k]);
+  }
+}
+
+void ObjectiveInput::readProviderValues(int timeIndex, double *values) const
+{
+  const int *providerGeometries = m_mappedProviderGeometries.data();
+  size_t mappedCount = m_mappedProviderGeometries.size();
+  const double *slice = nullptr;
+
+  if(m_valueArrayProvider && (slice = m_valueArrayProvider->timeSliceValues(timeIndex)))
+  {
+    if(m_contiguousProviderOffset >= 0)
+    {
+      memcpy(values, slice + m_contiguousProviderOffset, mappedCount * sizeof(double));
+    }
+    else
+    {
+      for(size_t k = 0; k < mappedCount; k++)
+      {
+        values[k] = slice[providerGeometries[k]];
+      }
+    }
+  }
+  else
+  {
+    for(size_t k = 0; k < mappedCount; k++)
+    {
+      m_timeGeometryProvider->getValue(timeIndex, providerGeometries[k], &values[k]);
+    }
+  }
 }
@@ -5,6 +5,7 @@
 #include "core/dimension.h"
 #include "core/valuedefinition.h"
 
+#include <limits>
 #include <unordered_map>
 
 using namespace HydroCouple;
@@ -21,7 +22,8 @@ ObjectiveOutput::ObjectiveOutput(const QString &id,
                          component),
     m_objectiveInput(objectiveInput),
     m_algorithm(algorithm),
-    m_objectiveFunctionComponent(component)
+    m_objectiveFunctionComponent(component),
+    m_evaluated(false)
 {
 
 }
@@ -62,89 +64,73 @@ void ObjectiveOutput::updateValues(HydroCouple::IInput *querySpecifier)
 
 void ObjectiveOutput::updateValues()
 {
+  if(m_evaluated)
+    return;
+
   if(m_objectiveInput->currentDateTime() >= m_objectiveFunctionComponent->timeHorizon()->julianDay() + m_objectiveFunctionComponent->timeHorizon()->duration())
   {
-    for(int g = 0; g < geometryCount(); g++)
-    {
-      std::vector<double> obsValues;
-      std::vector<double> simValues;
+    evaluate();
+  }
+  else if(m_objectiveFunctionComponent->runningOutputsDue())
+  {
+    evaluateRunning();
+    refreshAdaptedOutputs();
+  }
+}
 
-      double obsValueSum = 0;
-      double simValueSum = 0;
+TSObjectiveFunctionComponent::Algorithm ObjectiveOutput::algorithm() const
+{
+  return m_algorithm;
+}
 
-      for(int i = 0 ; i < m_objectiveInput->timeCount(); i++)
-      {
-        int index = m_objectiveInput->startDateTimeIndex() +  i;
-
-        double obsDateTime = m_objectiveInput->timeSeries()->dateTime(index);
-        double simDateTime = m_objectiveInput->time(i)->julianDay();
-
-        if(obsDateTime == simDateTime)
-        {
-          double simValue = 0.0;
-          m_objectiveInput->getValue(i, g, & simValue);
-          simValueSum += simValue;
-          simValues.push_back(simValue);
-
-          double obsValue = m_objectiveInput->timeSeries()->value(index, g);
-          obsValueSum += obsValue;
-          obsValues.push_back(obsValue);
-        }
-      }
+ObjectiveInput *ObjectiveOutput::objectiveInput() const
+{
+  return m_objectiveInput;
+}
 
-      double numValues = obsValues.size();
+void ObjectiveOutput::evaluate()
+{
+  evaluateRunning();
+  m_evaluated = true;
+}
 
-      switch (m_algorithm)
-      {
-        case TSObjectiveFunctionComponent::NashSutcliff:
-          {
-            double numer = 0.0;
-            double denom = 0.0;
-
-            for(size_t l = 0; l < obsValues.size(); l++)
-            {
-              double diffNumer = obsValues[l] - simValues[l];
-              double diffDenom = obsValues[l] - obsValueSum / numValues;
-              numer += diffNumer * diffNumer;
-              denom += diffDenom * diffDenom;
-            }
-
-            double metric = numer/denom;
-            metric = isinf(metric) || isnan(metric) ? std::numeric_limits<double>::max() : metric;
-            setValue(g, &metric);
-          }
-          break;
-        case TSObjectiveFunctionComponent::RMSE:
-          {
-            double sumDiffSqr = 0.0;
-
-            for(size_t l = 0; l < obsValues.size(); l++)
-            {
-              double diff = obsValues[l] - simValues[l];
-              sumDiffSqr += diff * diff;
-            }
-
-            double metric = sqrt(sumDiffSqr / numValues);
-            metric = isinf(metric) || isnan(metric) ? std::numeric_limits<double>::max() : metric;
-            setValue(g, &metric);
-          }
-          break;
-        case TSObjectiveFunctionComponent::MAE:
-          {
-            double sumAbsDiff = 0.0;
-
-            for(size_t l = 0; l < obsValues.size(); l++)
-            {
-              sumAbsDiff += fabs(obsValues[l] - simValues[l]);
-            }
-
-            double metric = sqrt(sumAbsDiff / numValues);
-            metric = isinf(metric) || isnan(metric) ? std::numeric_limits<double>::max() : metric;
-            setValue(g, &metric);
-          }
-          break;
+void ObjectiveOutput::evaluateRunning()
+{
+  m_metrics.resize(geometryCount());
+  m_objectiveInput->metrics(m_algorithm, m_metrics.data());
 
-      }
-    }
+  for(int g = 0; g < geometryCount(); g++)
+  {
+    setValue(g, &m_metrics[g]);
+  }
+}
+
+void ObjectiveOutput::prune()
+{
+  m_metrics.assign(geometryCount(), std::numeric_limits<double>::max());
+
+  for(int g = 0; g < geometryCount(); g++)
+  {
+    setValue(g, &m_metrics[g]);
+  }
+
+  m_evaluated = true;
+}
+
+void ObjectiveOutput::reset()
+{
+  double defaultValue = valueDefinition()->defaultValue().toDouble();
+
+  for(int g = 0; g < geometryCount(); g++)
+  {
+    setValue(g, &defaultValue);
   }
+
+  m_metrics.clear();
+  m_evaluated = false;
+}
+
+const double *ObjectiveOutput::geometryValues() const
+{
+  return m_metrics.size() ? m_metrics.data() : nullptr;
 }
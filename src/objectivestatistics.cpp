@@ -0,0 +1,206 @@
+#include "stdafx.h"
+#include "objectivestatistics.h"
+
+#include <cmath>
+#include <limits>
+
+ObjectiveStatistics::ObjectiveStatistics()
+{
+  reset();
+}
+
+void ObjectiveStatistics::reset()
+{
+  m_count = 0.0;
+  m_observedMean = 0.0;
+  m_simulatedMean = 0.0;
+  m_observedM2 = 0.0;
+  m_simulatedM2 = 0.0;
+  m_crossM2 = 0.0;
+  m_sumSquaredErrors = 0.0;
+  m_sumSquaredErrorsComp = 0.0;
+  m_sumAbsoluteErrors = 0.0;
+  m_sumAbsoluteErrorsComp = 0.0;
+  m_logCount = 0.0;
+  m_logObservedMean = 0.0;
+  m_logObservedM2 = 0.0;
+  m_logSumSquaredErrors = 0.0;
+  m_logSumSquaredErrorsComp = 0.0;
+}
+
+void ObjectiveStatistics::add(double observed, double simulated)
+{
+  m_count += 1.0;
+
+  double observedDelta = observed - m_observedMean;
+  double simulatedDelta = simulated - m_simulatedMean;
+
+  m_observedMean += observedDelta / m_count;
+  m_simulatedMean += simulatedDelta / m_count;
+
+  m_observedM2 += observedDelta * (observed - m_observedMean);
+  m_simulatedM2 += simulatedDelta * (simulated - m_simulatedMean);
+  m_crossM2 += observedDelta * (simulated - m_simulatedMean);
+
+  double error = observed - simulated;
+  compensatedAdd(m_sumSquaredErrors, m_sumSquaredErrorsComp, error * error);
+  compensatedAdd(m_sumAbsoluteErrors, m_sumAbsoluteErrorsComp, fabs(error));
+}
+
+void ObjectiveStatistics::addLogarithmic(double observed, double simulated)
+{
+  if(observed > 0.0 && simulated > 0.0)
+  {
+    double logObserved = log(observed);
+    double logSimulated = log(simulated);
+
+    m_logCount += 1.0;
+
+    double delta = logObserved - m_logObservedMean;
+    m_logObservedMean += delta / m_logCount;
+    m_logObservedM2 += delta * (logObserved - m_logObservedMean);
+
+    double error = logObserved - logSimulated;
+    compensatedAdd(m_logSumSquaredErrors, m_logSumSquaredErrorsComp, error * error);
+  }
+}
+
+void ObjectiveStatistics::merge(const ObjectiveStatistics &statistics)
+{
+  if(statistics.m_count > 0.0)
+  {
+    double count = m_count + statistics.m_count;
+    double observedDelta = statistics.m_observedMean - m_observedMean;
+    double simulatedDelta = statistics.m_simulatedMean - m_simulatedMean;
+    double weight = m_count * statistics.m_count / count;
+
+    m_observedM2 += statistics.m_observedM2 + observedDelta * observedDelta * weight;
+    m_simulatedM2 += statistics.m_simulatedM2 + simulatedDelta * simulatedDelta * weight;
+    m_crossM2 += statistics.m_crossM2 + observedDelta * simulatedDelta * weight;
+    m_observedMean += observedDelta * statistics.m_count / count;
+    m_simulatedMean += simulatedDelta * statistics.m_count / count;
+    m_count = count;
+
+    //The compensated sum of the other statistics is sum - compensation.
+    compensatedAdd(m_sumSquaredErrors, m_sumSquaredErrorsComp, statistics.m_sumSquaredErrors);
+    compensatedAdd(m_sumSquaredErrors, m_sumSquaredErrorsComp, -statistics.m_sumSquaredErrorsComp);
+    compensatedAdd(m_sumAbsoluteErrors, m_sumAbsoluteErrorsComp, statistics.m_sumAbsoluteErrors);
+    compensatedAdd(m_sumAbsoluteErrors, m_sumAbsoluteErrorsComp, -statistics.m_sumAbsoluteErrorsComp);
+  }
+
+  if(statistics.m_logCount > 0.0)
+  {
+    double logCount = m_logCount + statistics.m_logCount;
+    double delta = statistics.m_logObservedMean - m_logObservedMean;
+
+    m_logObservedM2 += statistics.m_logObservedM2 + delta * delta * m_logCount * statistics.m_logCount / logCount;
+    m_logObservedMean += delta * statistics.m_logCount / logCount;
+    m_logCount = logCount;
+
+    compensatedAdd(m_logSumSquaredErrors, m_logSumSquaredErrorsComp, statistics.m_logSumSquaredErrors);
+    compensatedAdd(m_logSumSquaredErrors, m_logSumSquaredErrorsComp, -statistics.m_logSumSquaredErrorsComp);
+  }
+}
+
+double ObjectiveStatistics::count() const
+{
+  return m_count;
+}
+
+double ObjectiveStatistics::observedMean() const
+{
+  return m_observedMean;
+}
+
+double ObjectiveStatistics::simulatedMean() const
+{
+  return m_simulatedMean;
+}
+
+double ObjectiveStatistics::observedSumSquaredDeviations() const
+{
+  return m_observedM2;
+}
+
+double ObjectiveStatistics::simulatedSumSquaredDeviations() const
+{
+  return m_simulatedM2;
+}
+
+double ObjectiveStatistics::sumCrossDeviations() const
+{
+  return m_crossM2;
+}
+
+double ObjectiveStatistics::sumSquaredErrors() const
+{
+  return m_sumSquaredErrors;
+}
+
+double ObjectiveStatistics::sumAbsoluteErrors() const
+{
+  return m_sumAbsoluteErrors;
+}
+
+double ObjectiveStatistics::logarithmicCount() const
+{
+  return m_logCount;
+}
+
+double ObjectiveStatistics::metric(TSObjectiveFunctionComponent::Algorithm algorithm) const
+{
+  double metric = std::numeric_limits<double>::quiet_NaN();
+
+  switch (algorithm)
+  {
+    case TSObjectiveFunctionComponent::NashSutcliff:
+      {
+        metric = m_sumSquaredErrors / m_observedM2;
+      }
+      break;
+    case TSObjectiveFunctionComponent::RMSE:
+      {
+        metric = sqrt(m_sumSquaredErrors / m_count);
+      }
+      break;
+    case TSObjectiveFunctionComponent::MAE:
+      {
+        metric = sqrt(m_sumAbsoluteErrors / m_count);
+      }
+      break;
+    case TSObjectiveFunctionComponent::KlingGupta:
+      {
+        double r = m_crossM2 / sqrt(m_observedM2 * m_simulatedM2);
+        double alpha = sqrt(m_simulatedM2 / m_observedM2);
+        double beta = m_simulatedMean / m_observedMean;
+
+        metric = sqrt((r - 1.0) * (r - 1.0) + (alpha - 1.0) * (alpha - 1.0) + (beta - 1.0) * (beta - 1.0));
+      }
+      break;
+    case TSObjectiveFunctionComponent::PercentBias:
+      {
+        metric = fabs(100.0 * (m_observedMean - m_simulatedMean) / m_observedMean);
+      }
+      break;
+    case TSObjectiveFunctionComponent::LogNashSutcliff:
+      {
+        metric = m_logSumSquaredErrors / m_logObservedM2;
+      }
+      break;
+    case TSObjectiveFunctionComponent::RSquared:
+      {
+        metric = 1.0 - (m_crossM2 * m_crossM2) / (m_observedM2 * m_simulatedM2);
+      }
+      break;
+  }
+
+  return std::isinf(metric) || std::isnan(metric) ? std::numeric_limits<double>::max() : metric;
+}
+
+void ObjectiveStatistics::compensatedAdd(double &sum, double &compensation, double value)
+{
+  double y = value - compensation;
+  double t = sum + y;
+  compensation = (t - sum) - y;
+  sum = t;
+}
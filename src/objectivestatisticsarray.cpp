@@ -0,0 +1,584 @@
+#include "stdafx.h"
+#include "objectivestatisticsarray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TSOBJECTIVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef USE_MPI
+#include <mpi.h>
+#include <vector>
+#endif
+
+namespace
+{
+  const int NumFields = 15;
+  const int Alignment = 64;
+  const int AlignmentDoubles = Alignment / sizeof(double);
+
+  //Geometries per thread when accumulating in parallel. A multiple of the alignment keeps every chunk aligned.
+  const int ParallelChunk = 1024;
+
+  struct Fields
+  {
+    double *count, *observedMean, *simulatedMean,
+    *observedM2, *simulatedM2, *crossM2,
+    *sumSquaredErrors, *sumSquaredErrorsComp,
+    *sumAbsoluteErrors, *sumAbsoluteErrorsComp;
+  };
+
+  /*!
+   * \brief addScalar must mirror ObjectiveStatistics::add and the vector kernels operation for operation.
+   */
+  inline void addScalar(int i, double observed, double simulated, const Fields &f)
+  {
+    double count = f.count[i] + 1.0;
+    double observedDelta = observed - f.observedMean[i];
+    double simulatedDelta = simulated - f.simulatedMean[i];
+    double observedMean = f.observedMean[i] + observedDelta / count;
+    double simulatedMean = f.simulatedMean[i] + simulatedDelta / count;
+
+    f.count[i] = count;
+    f.observedMean[i] = observedMean;
+    f.simulatedMean[i] = simulatedMean;
+    f.observedM2[i] += observedDelta * (observed - observedMean);
+    f.simulatedM2[i] += simulatedDelta * (simulated - simulatedMean);
+    f.crossM2[i] += observedDelta * (simulated - simulatedMean);
+
+    double error = observed - simulated;
+
+    double y = error * error - f.sumSquaredErrorsComp[i];
+    double t = f.sumSquaredErrors[i] + y;
+    f.sumSquaredErrorsComp[i] = (t - f.sumSquaredErrors[i]) - y;
+    f.sumSquaredErrors[i] = t;
+
+    y = fabs(error) - f.sumAbsoluteErrorsComp[i];
+    t = f.sumAbsoluteErrors[i] + y;
+    f.sumAbsoluteErrorsComp[i] = (t - f.sumAbsoluteErrors[i]) - y;
+    f.sumAbsoluteErrors[i] = t;
+  }
+
+  void addScalarKernel(int size, const double *observed, const double *simulated, const Fields &f)
+  {
+    for(int i = 0; i < size; i++)
+    {
+      addScalar(i, observed[i], simulated[i], f);
+    }
+  }
+
+#ifdef TSOBJECTIVE_X86_KERNELS
+
+  __attribute__((target("avx2")))
+  void addAVX2Kernel(int size, const double *observed, const double *simulated, const Fields &f)
+  {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+
+    int i = 0;
+
+    for(; i + 4 <= size; i += 4)
+    {
+      __m256d obs = _mm256_loadu_pd(observed + i);
+      __m256d sim = _mm256_loadu_pd(simulated + i);
+
+      __m256d count = _mm256_add_pd(_mm256_load_pd(f.count + i), one);
+      __m256d observedMean = _mm256_load_pd(f.observedMean + i);
+      __m256d simulatedMean = _mm256_load_pd(f.simulatedMean + i);
+      __m256d observedDelta = _mm256_sub_pd(obs, observedMean);
+      __m256d simulatedDelta = _mm256_sub_pd(sim, simulatedMean);
+      observedMean = _mm256_add_pd(observedMean, _mm256_div_pd(observedDelta, count));
+      simulatedMean = _mm256_add_pd(simulatedMean, _mm256_div_pd(simulatedDelta, count));
+
+      _mm256_store_pd(f.count + i, count);
+      _mm256_store_pd(f.observedMean + i, observedMean);
+      _mm256_store_pd(f.simulatedMean + i, simulatedMean);
+
+      __m256d simulatedResidual = _mm256_sub_pd(sim, simulatedMean);
+      _mm256_store_pd(f.observedM2 + i, _mm256_add_pd(_mm256_load_pd(f.observedM2 + i), _mm256_mul_pd(observedDelta, _mm256_sub_pd(obs, observedMean))));
+      _mm256_store_pd(f.simulatedM2 + i, _mm256_add_pd(_mm256_load_pd(f.simulatedM2 + i), _mm256_mul_pd(simulatedDelta, simulatedResidual)));
+      _mm256_store_pd(f.crossM2 + i, _mm256_add_pd(_mm256_load_pd(f.crossM2 + i), _mm256_mul_pd(observedDelta, simulatedResidual)));
+
+      __m256d error = _mm256_sub_pd(obs, sim);
+
+      __m256d sum = _mm256_load_pd(f.sumSquaredErrors + i);
+      __m256d y = _mm256_sub_pd(_mm256_mul_pd(error, error), _mm256_load_pd(f.sumSquaredErrorsComp + i));
+      __m256d t = _mm256_add_pd(sum, y);
+      _mm256_store_pd(f.sumSquaredErrorsComp + i, _mm256_sub_pd(_mm256_sub_pd(t, sum), y));
+      _mm256_store_pd(f.sumSquaredErrors + i, t);
+
+      sum = _mm256_load_pd(f.sumAbsoluteErrors + i);
+      y = _mm256_sub_pd(_mm256_andnot_pd(signMask, error), _mm256_load_pd(f.sumAbsoluteErrorsComp + i));
+      t = _mm256_add_pd(sum, y);
+      _mm256_store_pd(f.sumAbsoluteErrorsComp + i, _mm256_sub_pd(_mm256_sub_pd(t, sum), y));
+      _mm256_store_pd(f.sumAbsoluteErrors + i, t);
+    }
+
+    for(; i < size; i++)
+    {
+      addScalar(i, observed[i], simulated[i], f);
+    }
+  }
+
+  __attribute__((target("avx512f")))
+  void addAVX512Kernel(int size, const double *observed, const double *simulated, const Fields &f)
+  {
+    const __m512d one = _mm512_set1_pd(1.0);
+
+    int i = 0;
+
+    for(; i + 8 <= size; i += 8)
+    {
+      __m512d obs = _mm512_loadu_pd(observed + i);
+      __m512d sim = _mm512_loadu_pd(simulated + i);
+
+      __m512d count = _mm512_add_pd(_mm512_load_pd(f.count + i), one);
+      __m512d observedMean = _mm512_load_pd(f.observedMean + i);
+      __m512d simulatedMean = _mm512_load_pd(f.simulatedMean + i);
+      __m512d observedDelta = _mm512_sub_pd(obs, observedMean);
+      __m512d simulatedDelta = _mm512_sub_pd(sim, simulatedMean);
+      observedMean = _mm512_add_pd(observedMean, _mm512_div_pd(observedDelta, count));
+      simulatedMean = _mm512_add_pd(simulatedMean, _mm512_div_pd(simulatedDelta, count));
+
+      _mm512_store_pd(f.count + i, count);
+      _mm512_store_pd(f.observedMean + i, observedMean);
+      _mm512_store_pd(f.simulatedMean + i, simulatedMean);
+
+      __m512d simulatedResidual = _mm512_sub_pd(sim, simulatedMean);
+      _mm512_store_pd(f.observedM2 + i, _mm512_add_pd(_mm512_load_pd(f.observedM2 + i), _mm512_mul_pd(observedDelta, _mm512_sub_pd(obs, observedMean))));
+      _mm512_store_pd(f.simulatedM2 + i, _mm512_add_pd(_mm512_load_pd(f.simulatedM2 + i), _mm512_mul_pd(simulatedDelta, simulatedResidual)));
+      _mm512_store_pd(f.crossM2 + i, _mm512_add_pd(_mm512_load_pd(f.crossM2 + i), _mm512_mul_pd(observedDelta, simulatedResidual)));
+
+      __m512d error = _mm512_sub_pd(obs, sim);
+
+      __m512d sum = _mm512_load_pd(f.sumSquaredErrors + i);
+      __m512d y = _mm512_sub_pd(_mm512_mul_pd(error, error), _mm512_load_pd(f.sumSquaredErrorsComp + i));
+      __m512d t = _mm512_add_pd(sum, y);
+      _mm512_store_pd(f.sumSquaredErrorsComp + i, _mm512_sub_pd(_mm512_sub_pd(t, sum), y));
+      _mm512_store_pd(f.sumSquaredErrors + i, t);
+
+      sum = _mm512_load_pd(f.sumAbsoluteErrors + i);
+      y = _mm512_sub_pd(_mm512_abs_pd(error), _mm512_load_pd(f.sumAbsoluteErrorsComp + i));
+      t = _mm512_add_pd(sum, y);
+      _mm512_store_pd(f.sumAbsoluteErrorsComp + i, _mm512_sub_pd(_mm512_sub_pd(t, sum), y));
+      _mm512_store_pd(f.sumAbsoluteErrors + i, t);
+    }
+
+    for(; i < size; i++)
+    {
+      addScalar(i, observed[i], simulated[i], f);
+    }
+  }
+
+#endif
+
+  void addKernel(ObjectiveStatisticsArray::Kernel kernel, int size, const double *observed, const double *simulated, const Fields &f)
+  {
+    switch (kernel)
+    {
+#ifdef TSOBJECTIVE_X86_KERNELS
+      case ObjectiveStatisticsArray::AVX512:
+        addAVX512Kernel(size, observed, simulated, f);
+        break;
+      case ObjectiveStatisticsArray::AVX2:
+        addAVX2Kernel(size, observed, simulated, f);
+        break;
+#endif
+      default:
+        addScalarKernel(size, observed, simulated, f);
+        break;
+    }
+  }
+
+  Fields offsetFields(const Fields &f, int offset)
+  {
+    Fields fields = {f.count + offset, f.observedMean + offset, f.simulatedMean + offset,
+                     f.observedM2 + offset, f.simulatedM2 + offset, f.crossM2 + offset,
+                     f.sumSquaredErrors + offset, f.sumSquaredErrorsComp + offset,
+                     f.sumAbsoluteErrors + offset, f.sumAbsoluteErrorsComp + offset};
+    return fields;
+  }
+}
+
+const int ObjectiveStatisticsArray::m_parallelThreshold = 4096;
+
+ObjectiveStatisticsArray::ObjectiveStatisticsArray()
+  : m_size(0),
+    m_stride(0),
+    m_kernel(Automatic),
+    m_data(nullptr)
+{
+  allocate(0);
+}
+
+ObjectiveStatisticsArray::~ObjectiveStatisticsArray()
+{
+  deallocate();
+}
+
+int ObjectiveStatisticsArray::size() const
+{
+  return m_size;
+}
+
+void ObjectiveStatisticsArray::resize(int size)
+{
+  if(size != m_size)
+  {
+    deallocate();
+    allocate(size);
+  }
+
+  reset();
+}
+
+void ObjectiveStatisticsArray::reset()
+{
+  memset(m_data, 0, sizeof(double) * m_stride * NumFields);
+}
+
+ObjectiveStatisticsArray::Kernel ObjectiveStatisticsArray::kernel() const
+{
+  return m_kernel;
+}
+
+void ObjectiveStatisticsArray::setKernel(Kernel kernel)
+{
+  m_kernel = kernel;
+}
+
+ObjectiveStatisticsArray::Kernel ObjectiveStatisticsArray::activeKernel() const
+{
+  switch (m_kernel)
+  {
+    case AVX512:
+    case AVX2:
+      return isKernelSupported(m_kernel) ? m_kernel : Scalar;
+    case Scalar:
+      return Scalar;
+    case Automatic:
+    default:
+      {
+        static const Kernel automaticKernel = isKernelSupported(AVX512) ? AVX512 :
+                                              isKernelSupported(AVX2) ? AVX2 : Scalar;
+        return automaticKernel;
+      }
+  }
+}
+
+void ObjectiveStatisticsArray::add(const double *observed, const double *simulated)
+{
+  Fields fields = {m_count, m_observedMean, m_simulatedMean,
+                   m_observedM2, m_simulatedM2, m_crossM2,
+                   m_sumSquaredErrors, m_sumSquaredErrorsComp,
+                   m_sumAbsoluteErrors, m_sumAbsoluteErrorsComp};
+
+  Kernel kernel = activeKernel();
+
+#ifdef USE_OPENMP
+  //Geometries are independent lanes, so splitting them across threads does not change the results.
+  if(m_size >= m_parallelThreshold)
+  {
+    int chunks = (m_size + ParallelChunk - 1) / ParallelChunk;
+
+#pragma omp parallel for schedule(static)
+    for(int c = 0; c < chunks; c++)
+    {
+      int start = c * ParallelChunk;
+      addKernel(kernel, std::min(ParallelChunk, m_size - start), observed + start, simulated + start, offsetFields(fields, start));
+    }
+
+    return;
+  }
+#endif
+
+  addKernel(kernel, m_size, observed, simulated, fields);
+}
+
+void ObjectiveStatisticsArray::addLogarithmic(const double *observed, const double *simulated)
+{
+#ifdef USE_OPENMP
+#pragma omp parallel for if(m_size >= m_parallelThreshold)
+#endif
+  for(int i = 0; i < m_size; i++)
+  {
+    if(observed[i] > 0.0 && simulated[i] > 0.0)
+    {
+      double logObserved = log(observed[i]);
+      double logSimulated = log(simulated[i]);
+
+      m_logCount[i] += 1.0;
+
+      double delta = logObserved - m_logObservedMean[i];
+      m_logObservedMean[i] += delta / m_logCount[i];
+      m_logObservedM2[i] += delta * (logObserved - m_logObservedMean[i]);
+
+      double error = logObserved - logSimulated;
+      double y = error * error - m_logSumSquaredErrorsComp[i];
+      double t = m_logSumSquaredErrors[i] + y;
+      m_logSumSquaredErrorsComp[i] = (t - m_logSumSquaredErrors[i]) - y;
+      m_logSumSquaredErrors[i] = t;
+    }
+  }
+}
+
+ObjectiveStatistics ObjectiveStatisticsArray::statistics(int index) const
+{
+  return statistics(m_data, m_stride, index);
+}
+
+void ObjectiveStatisticsArray::setStatistics(int index, const ObjectiveStatistics &statistics)
+{
+  setStatistics(m_data, m_stride, index, statistics);
+}
+
+void ObjectiveStatisticsArray::clear(int index)
+{
+  for(int i = 0; i < NumFields; i++)
+  {
+    m_data[i * m_stride + index] = 0.0;
+  }
+}
+
+bool ObjectiveStatisticsArray::allReduce()
+{
+#ifdef USE_MPI
+
+  int initialized = 0, finalized = 0;
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+
+  if(initialized && !finalized)
+  {
+    int numRanks = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+
+    if(numRanks == 1)
+      return true;
+
+    int minSize = 0, maxSize = 0;
+    MPI_Allreduce(&m_size, &minSize, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(&m_size, &maxSize, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+
+    if(minSize == maxSize)
+    {
+      //The whole array is a single element of the reduction, so the Chan merge is applied once per pair of
+      //ranks instead of gathering the statistics of every rank. The operation is declared non-commutative so
+      //that ranks are merged in rank order and every rank obtains bitwise identical statistics. Same size
+      //implies the same stride on every rank.
+      MPI_Datatype arrayType;
+      MPI_Type_contiguous(m_stride * NumFields, MPI_DOUBLE, &arrayType);
+      MPI_Type_commit(&arrayType);
+
+      MPI_Op mergeOp;
+      MPI_Op_create(&mergeReduction, 0, &mergeOp);
+
+      std::vector<double> merged(static_cast<size_t>(m_stride) * NumFields);
+      MPI_Allreduce(m_data, merged.data(), 1, arrayType, mergeOp, MPI_COMM_WORLD);
+      std::copy(merged.begin(), merged.end(), m_data);
+
+      MPI_Op_free(&mergeOp);
+      MPI_Type_free(&arrayType);
+
+      return true;
+    }
+  }
+
+#endif
+
+  return false;
+}
+
+void ObjectiveStatisticsArray::metrics(TSObjectiveFunctionComponent::Algorithm algorithm, double *values) const
+{
+#ifdef USE_OPENMP
+#pragma omp parallel for if(m_size >= m_parallelThreshold)
+#endif
+  for(int i = 0; i < m_size; i++)
+  {
+    values[i] = statistics(i).metric(algorithm);
+  }
+}
+
+int ObjectiveStatisticsArray::parallelThreshold()
+{
+  return m_parallelThreshold;
+}
+
+bool ObjectiveStatisticsArray::isKernelSupported(Kernel kernel)
+{
+  switch (kernel)
+  {
+#ifdef TSOBJECTIVE_X86_KERNELS
+    case AVX512:
+      return __builtin_cpu_supports("avx512f");
+    case AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    case Scalar:
+    case Automatic:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool ObjectiveStatisticsArray::tryParseKernel(const QString &name, Kernel &kernel)
+{
+  if(!name.compare("AUTO", Qt::CaseInsensitive))
+  {
+    kernel = Automatic;
+  }
+  else if(!name.compare("SCALAR", Qt::CaseInsensitive))
+  {
+    kernel = Scalar;
+  }
+  else if(!name.compare("AVX2", Qt::CaseInsensitive))
+  {
+    kernel = AVX2;
+  }
+  else if(!name.compare("AVX512", Qt::CaseInsensitive))
+  {
+    kernel = AVX512;
+  }
+  else
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void ObjectiveStatisticsArray::allocate(int size)
+{
+  //Pad every field to a multiple of the alignment so each array starts on an aligned boundary.
+  int stride = ((size + AlignmentDoubles - 1) / AlignmentDoubles) * AlignmentDoubles;
+  stride = stride ? stride : AlignmentDoubles;
+  size_t bytes = sizeof(double) * stride * NumFields;
+
+#ifdef _WIN32
+  m_data = static_cast<double*>(_aligned_malloc(bytes, Alignment));
+#else
+  void *data = nullptr;
+  m_data = posix_memalign(&data, Alignment, bytes) == 0 ? static_cast<double*>(data) : nullptr;
+#endif
+
+  if(!m_data)
+    throw std::bad_alloc();
+
+  double **fields[NumFields] = {&m_count, &m_observedMean, &m_simulatedMean,
+                                &m_observedM2, &m_simulatedM2, &m_crossM2,
+                                &m_sumSquaredErrors, &m_sumSquaredErrorsComp,
+                                &m_sumAbsoluteErrors, &m_sumAbsoluteErrorsComp,
+                                &m_logCount, &m_logObservedMean, &m_logObservedM2,
+                                &m_logSumSquaredErrors, &m_logSumSquaredErrorsComp};
+
+  for(int i = 0; i < NumFields; i++)
+  {
+    *fields[i] = m_data + i * stride;
+  }
+
+  m_size = size;
+  m_stride = stride;
+  memset(m_data, 0, bytes);
+}
+
+ObjectiveStatistics ObjectiveStatisticsArray::statistics(const double *data, int stride, int index)
+{
+  //Field order must match allocate.
+  const double *field = data + index;
+
+  ObjectiveStatistics statistics;
+  statistics.m_count = field[0];
+  statistics.m_observedMean = field[stride];
+  statistics.m_simulatedMean = field[2 * stride];
+  statistics.m_observedM2 = field[3 * stride];
+  statistics.m_simulatedM2 = field[4 * stride];
+  statistics.m_crossM2 = field[5 * stride];
+  statistics.m_sumSquaredErrors = field[6 * stride];
+  statistics.m_sumSquaredErrorsComp = field[7 * stride];
+  statistics.m_sumAbsoluteErrors = field[8 * stride];
+  statistics.m_sumAbsoluteErrorsComp = field[9 * stride];
+  statistics.m_logCount = field[10 * stride];
+  statistics.m_logObservedMean = field[11 * stride];
+  statistics.m_logObservedM2 = field[12 * stride];
+  statistics.m_logSumSquaredErrors = field[13 * stride];
+  statistics.m_logSumSquaredErrorsComp = field[14 * stride];
+  return statistics;
+}
+
+void ObjectiveStatisticsArray::setStatistics(double *data, int stride, int index, const ObjectiveStatistics &statistics)
+{
+  //Field order must match allocate.
+  double *field = data + index;
+
+  field[0] = statistics.m_count;
+  field[stride] = statistics.m_observedMean;
+  field[2 * stride] = statistics.m_simulatedMean;
+  field[3 * stride] = statistics.m_observedM2;
+  field[4 * stride] = statistics.m_simulatedM2;
+  field[5 * stride] = statistics.m_crossM2;
+  field[6 * stride] = statistics.m_sumSquaredErrors;
+  field[7 * stride] = statistics.m_sumSquaredErrorsComp;
+  field[8 * stride] = statistics.m_sumAbsoluteErrors;
+  field[9 * stride] = statistics.m_sumAbsoluteErrorsComp;
+  field[10 * stride] = statistics.m_logCount;
+  field[11 * stride] = statistics.m_logObservedMean;
+  field[12 * stride] = statistics.m_logObservedM2;
+  field[13 * stride] = statistics.m_logSumSquaredErrors;
+  field[14 * stride] = statistics.m_logSumSquaredErrorsComp;
+}
+
+#ifdef USE_MPI
+
+void ObjectiveStatisticsArray::mergeReduction(void *invec, void *inoutvec, int *len, MPI_Datatype *datatype)
+{
+  int typeSize = 0;
+  MPI_Type_size(*datatype, &typeSize);
+
+  int stride = typeSize / static_cast<int>(sizeof(double) * NumFields);
+  const double *data = static_cast<const double*>(invec);
+  double *mergedData = static_cast<double*>(inoutvec);
+
+  //The lower ranks are in invec, so they are merged first.
+  for(int e = 0; e < *len; e++)
+  {
+    const double *element = data + static_cast<size_t>(e) * stride * NumFields;
+    double *mergedElement = mergedData + static_cast<size_t>(e) * stride * NumFields;
+
+    for(int i = 0; i < stride; i++)
+    {
+      ObjectiveStatistics merged = statistics(element, stride, i);
+      merged.merge(statistics(mergedElement, stride, i));
+      setStatistics(mergedElement, stride, i, merged);
+    }
+  }
+}
+
+#endif
+
+void ObjectiveStatisticsArray::deallocate()
+{
+  if(m_data)
+  {
+#ifdef _WIN32
+    _aligned_free(m_data);
+#else
+    free(m_data);
+#endif
+    m_data = nullptr;
+  }
+
+  m_size = 0;
+  m_stride = 0;
+}
@@ -0,0 +1,204 @@
+#include "stdafx.h"
+#include "observationindex.h"
+#include "observationseries.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  struct SeriesEntry
+  {
+    SeriesEntry()
+      : monotonic(-1)
+    {
+    }
+
+    int monotonic;
+    QHash<QString, QWeakPointer<const std::vector<int>>> windows;
+  };
+
+  QMutex &indexMutex()
+  {
+    static QMutex mutex;
+    return mutex;
+  }
+
+  QHash<QString, SeriesEntry> &indexEntries()
+  {
+    static QHash<QString, SeriesEntry> entries;
+    return entries;
+  }
+
+  /*!
+   * \brief pruneEntries drops windows no input holds anymore, then entries that are no longer used: entries whose
+   * windows have all expired and entries of earlier versions of the file of \p seriesKey. Must be called with the
+   * index mutex held.
+   */
+  void pruneEntries(const QString &seriesKey)
+  {
+    QString filePrefix = seriesKey.left(seriesKey.lastIndexOf('|') + 1);
+    QHash<QString, SeriesEntry> &entries = indexEntries();
+
+    for(auto it = entries.begin(); it != entries.end();)
+    {
+      QHash<QString, QWeakPointer<const std::vector<int>>> &windows = it.value().windows;
+      bool used = !windows.isEmpty();
+
+      for(auto window = windows.begin(); window != windows.end();)
+      {
+        if(window.value().isNull())
+        {
+          window = windows.erase(window);
+        }
+        else
+        {
+          ++window;
+        }
+      }
+
+      if(it.key() != seriesKey && windows.isEmpty() && (used || it.key().startsWith(filePrefix)))
+      {
+        it = entries.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+}
+
+QString ObservationIndex::seriesKey(const QString &filePath, qint64 lastModified)
+{
+  return filePath + "|" + QString::number(lastModified);
+}
+
+bool ObservationIndex::isMonotonic(const QString &seriesKey, ObservationSeries *timeSeries)
+{
+  if(!seriesKey.isEmpty())
+  {
+    QMutexLocker locker(&indexMutex());
+    SeriesEntry &entry = indexEntries()[seriesKey];
+
+    if(entry.monotonic >= 0)
+    {
+      return entry.monotonic;
+    }
+  }
+
+  bool monotonic = true;
+
+  for(int i = 1; i < timeSeries->numRows(); i++)
+  {
+    if(timeSeries->dateTime(i) < timeSeries->dateTime(i - 1))
+    {
+      monotonic = false;
+      break;
+    }
+  }
+
+  if(!seriesKey.isEmpty())
+  {
+    QMutexLocker locker(&indexMutex());
+    indexEntries()[seriesKey].monotonic = monotonic;
+  }
+
+  return monotonic;
+}
+
+int ObservationIndex::lowerBound(ObservationSeries *timeSeries, double dateTime)
+{
+  int first = 0;
+  int count = timeSeries->numRows();
+
+  while (count > 0)
+  {
+    int step = count / 2;
+    int middle = first + step;
+
+    if(timeSeries->dateTime(middle) < dateTime)
+    {
+      first = middle + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+
+  return first;
+}
+
+QSharedPointer<const std::vector<int>> ObservationIndex::alignedRows(const QString &seriesKey, ObservationSeries *timeSeries,
+                                                                     double startTime, double endTime, double tolerance)
+{
+  bool monotonic = isMonotonic(seriesKey, timeSeries);
+
+  if(seriesKey.isEmpty())
+  {
+    return createAlignedRows(timeSeries, monotonic, startTime, endTime, tolerance);
+  }
+
+  QString windowKey = QString::number(startTime, 'g', 17) + "|" +
+                      QString::number(endTime, 'g', 17) + "|" +
+                      QString::number(tolerance, 'g', 17);
+
+  {
+    QMutexLocker locker(&indexMutex());
+    QSharedPointer<const std::vector<int>> rows = indexEntries()[seriesKey].windows.value(windowKey).toStrongRef();
+
+    if(rows)
+    {
+      return rows;
+    }
+  }
+
+  QSharedPointer<const std::vector<int>> rows = createAlignedRows(timeSeries, monotonic, startTime, endTime, tolerance);
+
+  QMutexLocker locker(&indexMutex());
+  indexEntries()[seriesKey].windows[windowKey] = rows;
+  pruneEntries(seriesKey);
+
+  return rows;
+}
+
+QSharedPointer<const std::vector<int>> ObservationIndex::createAlignedRows(ObservationSeries *timeSeries, bool monotonic,
+                                                                           double startTime, double endTime, double tolerance)
+{
+  std::vector<int> *rows = new std::vector<int>();
+  double lastDateTime = -std::numeric_limits<double>::max();
+
+  int first = monotonic ? lowerBound(timeSeries, startTime - tolerance) : 0;
+  int last = monotonic ? lowerBound(timeSeries, std::nextafter(endTime + tolerance, std::numeric_limits<double>::max())) : timeSeries->numRows();
+
+  if(monotonic)
+  {
+    rows->reserve(last - first);
+  }
+
+  for(int i = first; i < last; i++)
+  {
+    double dateTime = timeSeries->dateTime(i);
+
+    if(dateTime > endTime + tolerance)
+    {
+      break;
+    }
+    else if(dateTime >= startTime - tolerance && dateTime > lastDateTime + tolerance)
+    {
+      rows->push_back(i);
+      lastDateTime = dateTime;
+    }
+  }
+
+  rows->shrink_to_fit();
+
+  return QSharedPointer<const std::vector<int>>(rows);
+}
@@ -0,0 +1,212 @@
+#include "stdafx.h"
+#include "observationseries.h"
+#include "temporal/timeseries.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+  struct SidecarHeader
+  {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;
+    qint64 sourceModified;
+    qint64 sourceSize;
+    qint64 numRows;
+    qint64 numColumns;
+    quint64 payloadChecksum;
+    quint64 headerChecksum;
+  };
+
+  static_assert(sizeof(SidecarHeader) == 64, "Observation sidecar header must be 64 bytes");
+}
+
+const char ObservationSeries::m_magic[8] = {'T', 'S', 'O', 'B', 'S', 'B', 'I', 'N'};
+
+const quint32 ObservationSeries::m_version = 1;
+
+ObservationSeries::ObservationSeries()
+  : m_numRows(0),
+    m_numColumns(0),
+    m_dateTimes(nullptr),
+    m_values(nullptr),
+    m_mappedData(nullptr)
+{
+}
+
+ObservationSeries::ObservationSeries(TimeSeries *timeSeries)
+  : ObservationSeries()
+{
+  m_numRows = timeSeries->numRows();
+  m_numColumns = timeSeries->numColumns();
+
+  m_ownedDateTimes.resize(m_numRows);
+  m_ownedValues.resize(static_cast<size_t>(m_numRows) * m_numColumns);
+
+  for(int i = 0; i < m_numRows; i++)
+  {
+    m_ownedDateTimes[i] = timeSeries->dateTime(i);
+
+    for(int j = 0; j < m_numColumns; j++)
+    {
+      m_ownedValues[static_cast<size_t>(i) * m_numColumns + j] = timeSeries->value(i, j);
+    }
+  }
+
+  m_dateTimes = m_ownedDateTimes.data();
+  m_values = m_ownedValues.data();
+}
+
+ObservationSeries::~ObservationSeries()
+{
+  if(m_mappedData)
+  {
+    m_mappedFile.unmap(m_mappedData);
+    m_mappedData = nullptr;
+  }
+
+  if(m_mappedFile.isOpen())
+  {
+    m_mappedFile.close();
+  }
+}
+
+bool ObservationSeries::isMapped() const
+{
+  return m_mappedData != nullptr;
+}
+
+QString ObservationSeries::sidecarFilePath(const QString &filePath)
+{
+  return filePath + ".obscache";
+}
+
+ObservationSeries *ObservationSeries::map(const QString &filePath, bool verifyPayload)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+
+  QFileInfo source(filePath);
+  QFileInfo sidecar(sidecarFilePath(filePath));
+
+  if(!source.isFile() || !sidecar.isFile() || sidecar.size() < static_cast<qint64>(sizeof(SidecarHeader)))
+  {
+    return nullptr;
+  }
+
+  ObservationSeries *series = new ObservationSeries();
+  series->m_mappedFile.setFileName(sidecar.absoluteFilePath());
+
+  if(series->m_mappedFile.open(QIODevice::ReadOnly))
+  {
+    qint64 fileSize = series->m_mappedFile.size();
+    uchar *data = series->m_mappedFile.map(0, fileSize);
+
+    if(data)
+    {
+      series->m_mappedData = data;
+
+      SidecarHeader header;
+      memcpy(&header, data, sizeof(SidecarHeader));
+
+      qint64 payloadSize = static_cast<qint64>(sizeof(double)) * (header.numRows + header.numRows * header.numColumns);
+
+      if(!memcmp(header.magic, m_magic, sizeof(m_magic)) &&
+         header.version == m_version &&
+         header.headerSize == sizeof(SidecarHeader) &&
+         header.headerChecksum == checksum(data, offsetof(SidecarHeader, headerChecksum)) &&
+         header.sourceModified == source.lastModified().toMSecsSinceEpoch() &&
+         header.sourceSize == source.size() &&
+         header.numRows >= 0 && header.numColumns >= 0 &&
+         fileSize == static_cast<qint64>(sizeof(SidecarHeader)) + payloadSize &&
+         (!verifyPayload || header.payloadChecksum == checksum(data + sizeof(SidecarHeader), payloadSize)))
+      {
+        series->m_numRows = static_cast<int>(header.numRows);
+        series->m_numColumns = static_cast<int>(header.numColumns);
+        series->m_dateTimes = reinterpret_cast<const double*>(data + sizeof(SidecarHeader));
+        series->m_values = series->m_dateTimes + header.numRows;
+
+        return series;
+      }
+    }
+  }
+
+  delete series;
+
+#else
+  Q_UNUSED(filePath)
+  Q_UNUSED(verifyPayload)
+#endif
+
+  return nullptr;
+}
+
+bool ObservationSeries::writeSidecar(const QString &filePath) const
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+
+  QFileInfo source(filePath);
+
+  if(!source.isFile())
+    return false;
+
+  qint64 dateTimesSize = static_cast<qint64>(sizeof(double)) * m_numRows;
+  qint64 valuesSize = static_cast<qint64>(sizeof(double)) * m_numRows * m_numColumns;
+
+  SidecarHeader header;
+  memset(&header, 0, sizeof(SidecarHeader));
+  memcpy(header.magic, m_magic, sizeof(m_magic));
+  header.version = m_version;
+  header.headerSize = sizeof(SidecarHeader);
+  header.sourceModified = source.lastModified().toMSecsSinceEpoch();
+  header.sourceSize = source.size();
+  header.numRows = m_numRows;
+  header.numColumns = m_numColumns;
+  header.payloadChecksum = checksum(reinterpret_cast<const uchar*>(m_values), valuesSize,
+                                    checksum(reinterpret_cast<const uchar*>(m_dateTimes), dateTimesSize));
+  header.headerChecksum = checksum(reinterpret_cast<const uchar*>(&header), offsetof(SidecarHeader, headerChecksum));
+
+  QSaveFile file(sidecarFilePath(filePath));
+
+  if(file.open(QIODevice::WriteOnly) &&
+     file.write(reinterpret_cast<const char*>(&header), sizeof(SidecarHeader)) == sizeof(SidecarHeader) &&
+     file.write(reinterpret_cast<const char*>(m_dateTimes), dateTimesSize) == dateTimesSize &&
+     file.write(reinterpret_cast<const char*>(m_values), valuesSize) == valuesSize)
+  {
+    return file.commit();
+  }
+
+  file.cancelWriting();
+
+#else
+  Q_UNUSED(filePath)
+#endif
+
+  return false;
+}
+
+quint64 ObservationSeries::checksum(const uchar *data, qint64 size, quint64 hash)
+{
+  //FNV-1a over 64 bit words with a byte wise tail.
+  const quint64 prime = 1099511628211ULL;
+  qint64 i = 0;
+
+  for(; i + 8 <= size; i += 8)
+  {
+    quint64 word;
+    memcpy(&word, data + i, sizeof(quint64));
+    hash = (hash ^ word) * prime;
+  }
+
+  for(; i < size; i++)
+  {
+    hash = (hash ^ data[i]) * prime;
+  }
+
+  return hash;
+}
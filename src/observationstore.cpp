@@ -0,0 +1,123 @@
+#include "stdafx.h"
+#include "observationstore.h"
+#include "observationindex.h"
+#include "observationseries.h"
+#include "temporal/timeseries.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWeakPointer>
+
+namespace
+{
+  QMutex &storeMutex()
+  {
+    static QMutex mutex;
+    return mutex;
+  }
+
+  QHash<QString, QWeakPointer<ObservationSeries>> &storeEntries()
+  {
+    static QHash<QString, QWeakPointer<ObservationSeries>> entries;
+    return entries;
+  }
+
+  /*!
+   * \brief verifiedSidecars maps an observation file to the series key of the last version whose sidecar payload
+   * was verified or written by this process.
+   */
+  QHash<QString, QString> &verifiedSidecars()
+  {
+    static QHash<QString, QString> sidecars;
+    return sidecars;
+  }
+
+  /*!
+   * \brief pruneEntries drops entries no component holds anymore and entries of earlier versions of the file
+   * whose versioned key starts with \p filePrefix. Must be called with the store mutex held.
+   */
+  void pruneEntries(const QString &filePrefix)
+  {
+    QHash<QString, QWeakPointer<ObservationSeries>> &entries = storeEntries();
+
+    for(auto it = entries.begin(); it != entries.end();)
+    {
+      if(it.value().isNull() || (!filePrefix.isEmpty() && it.key().startsWith(filePrefix)))
+      {
+        it = entries.erase(it);
+      }
+      else
+      {
+        it++;
+      }
+    }
+  }
+}
+
+QSharedPointer<ObservationSeries> ObservationStore::timeSeries(const QFileInfo &file, QString &seriesKey, bool binaryCache)
+{
+  seriesKey = ObservationIndex::seriesKey(file.absoluteFilePath(), file.lastModified().toMSecsSinceEpoch());
+
+  //Loading is done under the lock so that clones initializing concurrently read a file only once.
+  QMutexLocker locker(&storeMutex());
+
+  QSharedPointer<ObservationSeries> timeSeries = storeEntries().value(seriesKey).toStrongRef();
+
+  if(timeSeries.isNull())
+  {
+    //The payload checksum is verified the first time a process maps a sidecar. Later mappings of the same
+    //version only validate the header.
+    bool verifyPayload = verifiedSidecars().value(file.absoluteFilePath()) != seriesKey;
+    ObservationSeries *series = binaryCache ? ObservationSeries::map(file.absoluteFilePath(), verifyPayload) : nullptr;
+
+    if(series)
+    {
+      verifiedSidecars()[file.absoluteFilePath()] = seriesKey;
+    }
+
+    if(!series)
+    {
+      TimeSeries *timeSeriesObj = TimeSeries::createTimeSeries(file.completeBaseName(), file, nullptr);
+
+      if(timeSeriesObj)
+      {
+        series = new ObservationSeries(timeSeriesObj);
+        delete timeSeriesObj;
+
+        //Failing to write the sidecar, e.g., in a read-only directory, only means the next run parses the text again.
+        if(binaryCache && series->writeSidecar(file.absoluteFilePath()))
+        {
+          verifiedSidecars()[file.absoluteFilePath()] = seriesKey;
+        }
+      }
+    }
+
+    if(series)
+    {
+      timeSeries = QSharedPointer<ObservationSeries>(series);
+
+      //Components still holding an earlier version of the file keep it alive without the store.
+      pruneEntries(seriesKey.left(seriesKey.lastIndexOf('|') + 1));
+      storeEntries()[seriesKey] = timeSeries;
+
+      ObservationIndex::isMonotonic(seriesKey, series);
+    }
+    else
+    {
+      storeEntries().remove(seriesKey);
+    }
+  }
+
+  return timeSeries;
+}
+
+int ObservationStore::count()
+{
+  QMutexLocker locker(&storeMutex());
+
+  pruneEntries(QString());
+
+  return storeEntries().size();
+}
@@ -0,0 +1,186 @@
+#include "stdafx.h"
+#include "providergeometryindex.h"
+#include "hydrocouplespatial.h"
+#include "hydrocouplespatiotemporal.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace HydroCouple::Spatial;
+using namespace HydroCouple::SpatioTemporal;
+
+ProviderGeometryIndex::ProviderGeometryIndex(ITimeGeometryComponentDataItem *provider, double epsilon)
+  : m_provider(provider),
+    m_epsilon(epsilon)
+{
+  int geometryCount = provider->geometryCount();
+
+  m_geometryTypes.resize(geometryCount);
+  m_pointCounts.assign(geometryCount, 0);
+
+  for(int j = 0; j < geometryCount; j++)
+  {
+    IGeometry *geometry = provider->geometry(j);
+    m_geometryTypes[j] = geometry->geometryType();
+
+    ILineString *lineString = nullptr;
+
+    if(isLineString(m_geometryTypes[j]) && (lineString = dynamic_cast<ILineString*>(geometry)))
+    {
+      m_pointCounts[j] = lineString->pointCount();
+
+      for(int i = 0; i < lineString->pointCount(); i++)
+      {
+        IPoint *point = lineString->point(i);
+        qint64 column, row;
+
+        if(cellCoordinates(point->x(), point->y(), column, row))
+        {
+          Vertex vertex;
+          vertex.cell = cellKey(column, row);
+          vertex.geometryIndex = j;
+          vertex.pointIndex = i;
+          vertex.x = point->x();
+          vertex.y = point->y();
+          m_vertices.push_back(vertex);
+        }
+      }
+    }
+    else if(!isLineString(m_geometryTypes[j]))
+    {
+      m_otherGeometries.push_back(j);
+    }
+  }
+
+  //Vertices of a cell are contiguous and ordered by geometry index so the first match is the lowest index.
+  std::sort(m_vertices.begin(), m_vertices.end(), [](const Vertex &a, const Vertex &b)
+  {
+    return a.cell < b.cell || (a.cell == b.cell && (a.geometryIndex < b.geometryIndex ||
+                                                    (a.geometryIndex == b.geometryIndex && a.pointIndex < b.pointIndex)));
+  });
+}
+
+ProviderGeometryIndex::~ProviderGeometryIndex()
+{
+
+}
+
+int ProviderGeometryIndex::geometryCount() const
+{
+  return static_cast<int>(m_geometryTypes.size());
+}
+
+double ProviderGeometryIndex::epsilon() const
+{
+  return m_epsilon;
+}
+
+int ProviderGeometryIndex::findGeometry(IGeometry *geometry) const
+{
+  int geometryType = geometry->geometryType();
+  int match = -1;
+
+  ILineString *lineString = nullptr;
+
+  if(isLineString(geometryType))
+  {
+    if((lineString = dynamic_cast<ILineString*>(geometry)))
+    {
+      int pointCount = lineString->pointCount();
+
+      auto compareCell = [](const Vertex &vertex, quint64 cell)
+      {
+        return vertex.cell < cell;
+      };
+
+      for(int i = 0; i < pointCount; i++)
+      {
+        IPoint *point = lineString->point(i);
+        double x = point->x();
+        double y = point->y();
+        qint64 column, row;
+
+        if(!cellCoordinates(x, y, column, row))
+          continue;
+
+        //Vertices within epsilon are at most one cell away.
+        for(qint64 c = column - 1; c <= column + 1; c++)
+        {
+          for(qint64 r = row - 1; r <= row + 1; r++)
+          {
+            quint64 cell = cellKey(c, r);
+
+            for(auto it = std::lower_bound(m_vertices.begin(), m_vertices.end(), cell, compareCell);
+                it != m_vertices.end() && it->cell == cell; it++)
+            {
+              if(match >= 0 && it->geometryIndex >= match)
+                break;
+
+              if(it->pointIndex == i &&
+                 m_geometryTypes[it->geometryIndex] == geometryType &&
+                 m_pointCounts[it->geometryIndex] == pointCount)
+              {
+                double dx = x - it->x;
+                double dy = y - it->y;
+
+                double dist = sqrt(dx * dx + dy * dy);
+
+                if(dist < m_epsilon)
+                {
+                  match = it->geometryIndex;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  else
+  {
+    for(int j : m_otherGeometries)
+    {
+      if(m_geometryTypes[j] == geometryType && geometry->equals(m_provider->geometry(j)))
+      {
+        match = j;
+        break;
+      }
+    }
+  }
+
+  return match;
+}
+
+quint64 ProviderGeometryIndex::cellKey(qint64 column, qint64 row) const
+{
+  //Distinct cells may share a key. Candidates are always checked against their coordinates.
+  quint64 hash = static_cast<quint64>(column) * 0x9E3779B97F4A7C15ULL;
+  hash ^= static_cast<quint64>(row) + 0x7F4A7C159E3779B9ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+bool ProviderGeometryIndex::cellCoordinates(double x, double y, qint64 &column, qint64 &row) const
+{
+  double cx = std::floor(x / m_epsilon);
+  double cy = std::floor(y / m_epsilon);
+
+  //Cells are limited to a range where the neighbouring cells are exactly representable.
+  const double limit = 4.0e15;
+
+  if(cx > -limit && cx < limit && cy > -limit && cy < limit)
+  {
+    column = static_cast<qint64>(cx);
+    row = static_cast<qint64>(cy);
+    return true;
+  }
+
+  return false;
+}
+
+bool ProviderGeometryIndex::isLineString(int geometryType)
+{
+  return geometryType == IGeometry::LineString ||
+      geometryType == IGeometry::LineStringM ||
+      geometryType == IGeometry::LineStringZ ||
+      geometryType == IGeometry::LineStringZM;
+}
@@ -0,0 +1,617 @@
+#include "stdafx.h"
+#include "resultwriter.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QWaitCondition>
+#include <QWeakPointer>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#ifdef USE_NETCDF
+#include <netcdf>
+
+using namespace netCDF;
+using namespace netCDF::exceptions;
+#endif
+
+namespace
+{
+  QMutex &writerMutex()
+  {
+    static QMutex mutex;
+    return mutex;
+  }
+
+  QHash<QString, QWeakPointer<ResultWriter>> &writerEntries()
+  {
+    static QHash<QString, QWeakPointer<ResultWriter>> entries;
+    return entries;
+  }
+
+  /*!
+   * \brief writerClosed is signaled when a writer has flushed and closed its file and left the registry.
+   */
+  QWaitCondition &writerClosed()
+  {
+    static QWaitCondition condition;
+    return condition;
+  }
+
+#ifdef USE_NETCDF
+  /*!
+   * \brief netCDFMutex serializes every netCDF call. The netCDF and HDF5 libraries are not thread safe, even
+   * across different files, and every writer runs its own thread.
+   */
+  QMutex &netCDFMutex()
+  {
+    static QMutex mutex;
+    return mutex;
+  }
+#endif
+}
+
+int ResultLayout::valueCount() const
+{
+  int count = 0;
+
+  for(const Column &column : columns)
+  {
+    count += column.geometryCount;
+  }
+
+  return count;
+}
+
+int ResultLayout::geometryCount() const
+{
+  int count = 0;
+
+  for(const Column &column : columns)
+  {
+    count = std::max(count, column.geometryCount);
+  }
+
+  return count;
+}
+
+bool ResultLayout::operator==(const ResultLayout &layout) const
+{
+  if(objectives != layout.objectives || metrics != layout.metrics || columns.size() != layout.columns.size())
+    return false;
+
+  for(size_t i = 0; i < columns.size(); i++)
+  {
+    const Column &column = columns[i];
+    const Column &other = layout.columns[i];
+
+    if(column.id != other.id || column.objective != other.objective ||
+       column.metric != other.metric || column.geometryCount != other.geometryCount)
+      return false;
+  }
+
+  return true;
+}
+
+bool ResultLayout::operator!=(const ResultLayout &layout) const
+{
+  return !(*this == layout);
+}
+
+const int ResultWriter::m_batchSize = 64;
+const int ResultWriter::m_flushInterval = 250;
+const int ResultWriter::m_runIdSize = 64;
+
+QSharedPointer<ResultWriter> ResultWriter::open(const QString &filePath, Format format, const ResultLayout &layout, QString &error)
+{
+  QString key = QFileInfo(filePath).absoluteFilePath();
+
+#ifndef USE_NETCDF
+  if(format == NetCDF)
+  {
+    error = "NetCDF output is not supported by this build: " + key;
+    return QSharedPointer<ResultWriter>();
+  }
+#endif
+
+  QMutexLocker locker(&writerMutex());
+
+  QSharedPointer<ResultWriter> writer = writerEntries().value(key).toStrongRef();
+
+  //An expired entry belongs to a writer that is still flushing its last rows. Recreating the file now would truncate them.
+  while(writer.isNull() && writerEntries().contains(key))
+  {
+    writerClosed().wait(&writerMutex());
+    writer = writerEntries().value(key).toStrongRef();
+  }
+
+  if(writer.isNull())
+  {
+    writer = QSharedPointer<ResultWriter>(new ResultWriter(key, format, layout));
+
+    if(writer->isOpen())
+    {
+      writer->m_registered = true;
+      writerEntries()[key] = writer;
+    }
+    else
+    {
+      error = "Unable to open output file: " + key;
+      writer.clear();
+    }
+  }
+  else if(writer->m_format != format || writer->m_layout != layout)
+  {
+    error = "Output file is already written with a different format or layout: " + key;
+
+    //Releasing the reference may destroy the writer, which takes the registry lock.
+    locker.unlock();
+    writer.clear();
+  }
+
+  return writer;
+}
+
+ResultWriter::ResultWriter(const QString &filePath, Format format, const ResultLayout &layout)
+  : m_file(filePath),
+    m_format(format),
+    m_layout(layout),
+    m_open(false),
+    m_registered(false),
+    m_rowCount(0),
+    m_snapshotCount(0),
+#ifdef USE_NETCDF
+    m_ncFile(nullptr),
+#endif
+    m_records(nullptr),
+    m_pendingRecords(0),
+    m_stop(false)
+{
+  switch (m_format)
+  {
+    case CSV:
+      m_open = openCSV();
+      break;
+    case Binary:
+      m_open = openBinary();
+      break;
+    case NetCDF:
+#ifdef USE_NETCDF
+      m_open = openNetCDF();
+#endif
+      break;
+  }
+
+  if(m_open)
+  {
+    m_thread = std::thread(&ResultWriter::run, this);
+  }
+}
+
+ResultWriter::~ResultWriter()
+{
+  if(m_thread.joinable())
+  {
+    m_stop = true;
+    m_wake.notify_one();
+    m_thread.join();
+  }
+
+#ifdef USE_NETCDF
+  if(m_ncFile)
+  {
+    QMutexLocker locker(&netCDFMutex());
+    m_ncFile->close();
+    delete m_ncFile;
+    m_ncFile = nullptr;
+  }
+#endif
+
+  m_file.close();
+
+  if(m_registered)
+  {
+    QMutexLocker locker(&writerMutex());
+    writerEntries().remove(m_file.fileName());
+    writerClosed().wakeAll();
+  }
+}
+
+QString ResultWriter::filePath() const
+{
+  return m_file.fileName();
+}
+
+ResultWriter::Format ResultWriter::format() const
+{
+  return m_format;
+}
+
+bool ResultWriter::writesSnapshots() const
+{
+  return m_format != CSV;
+}
+
+void ResultWriter::write(const QString &runId, int iteration, const std::vector<double> &values)
+{
+  Record *record = new Record();
+  record->runId = runId;
+  record->iteration = iteration;
+  record->snapshot = false;
+  record->dateTime = std::numeric_limits<double>::quiet_NaN();
+  record->values = values;
+
+  push(record);
+}
+
+void ResultWriter::writeSnapshot(const QString &runId, int iteration, double dateTime, const std::vector<double> &values)
+{
+  if(!writesSnapshots())
+    return;
+
+  Record *record = new Record();
+  record->runId = runId;
+  record->iteration = iteration;
+  record->snapshot = true;
+  record->dateTime = dateTime;
+  record->values = values;
+
+  push(record);
+}
+
+bool ResultWriter::isOpen() const
+{
+  return m_open;
+}
+
+void ResultWriter::push(Record *record)
+{
+  record->next = m_records.load(std::memory_order_relaxed);
+
+  while (!m_records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+  {
+  }
+
+  //A full batch wakes the writer early. Otherwise rows are picked up at the next flush interval.
+  if(m_pendingRecords.fetch_add(1, std::memory_order_relaxed) + 1 == m_batchSize)
+  {
+    m_wake.notify_one();
+  }
+}
+
+void ResultWriter::run()
+{
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait_for(lock, std::chrono::milliseconds(m_flushInterval), [this]()
+      {
+        return m_stop.load() || m_pendingRecords.load(std::memory_order_relaxed) >= m_batchSize;
+      });
+    }
+
+    bool stop = m_stop.load();
+    Record *records = m_records.exchange(nullptr, std::memory_order_acquire);
+
+    if(records)
+    {
+      writeRecords(records);
+    }
+
+    if(stop && m_records.load(std::memory_order_acquire) == nullptr)
+      break;
+  }
+}
+
+void ResultWriter::writeRecords(Record *records)
+{
+  //The queue is a stack, so records are reversed to be written in the order they were queued.
+  Record *ordered = nullptr;
+  int count = 0;
+
+  while (records)
+  {
+    Record *next = records->next;
+    records->next = ordered;
+    ordered = records;
+    records = next;
+    count++;
+  }
+
+  switch (m_format)
+  {
+    case CSV:
+      writeCSV(ordered);
+      break;
+    case Binary:
+      writeBinary(ordered);
+      break;
+    case NetCDF:
+#ifdef USE_NETCDF
+      writeNetCDF(ordered);
+#endif
+      break;
+  }
+
+  while (ordered)
+  {
+    Record *record = ordered;
+    ordered = ordered->next;
+    delete record;
+  }
+
+  m_pendingRecords.fetch_sub(count, std::memory_order_relaxed);
+}
+
+bool ResultWriter::openCSV()
+{
+  if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  QTextStream stream(&m_file);
+  stream << "RunId, Iteration";
+
+  for(const ResultLayout::Column &column : m_layout.columns)
+  {
+    for(int g = 0; g < column.geometryCount; g++)
+    {
+      stream << ", " << column.id;
+    }
+  }
+
+  stream << "\n";
+  stream.flush();
+
+  return true;
+}
+
+void ResultWriter::writeCSV(Record *records)
+{
+  QTextStream stream(&m_file);
+  stream.setRealNumberPrecision(10);
+  stream.setRealNumberNotation(QTextStream::SmartNotation);
+
+  for(Record *record = records; record; record = record->next)
+  {
+    stream << record->runId << ", " << record->iteration;
+
+    for(double value : record->values)
+    {
+      stream << ", " << value;
+    }
+
+    stream << "\n";
+  }
+
+  stream.flush();
+  m_file.flush();
+}
+
+bool ResultWriter::openBinary()
+{
+  if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  qint32 objectiveCount = m_layout.objectives.size();
+  qint32 geometryCount = m_layout.geometryCount();
+  qint32 metricCount = m_layout.metrics.size();
+  qint32 recordSize = m_runIdSize + 2 * sizeof(qint32) + sizeof(double) + sizeof(double) * objectiveCount * geometryCount * metricCount;
+
+  QByteArray names;
+
+  for(const QString &name : m_layout.objectives + m_layout.metrics)
+  {
+    names.append(name.toUtf8());
+    names.append('\0');
+  }
+
+  qint32 headerSize = 8 + 5 * sizeof(qint32) + names.size();
+  qint32 dataOffset = (headerSize + 7) / 8 * 8;
+
+  names.append(QByteArray(dataOffset - headerSize, '\0'));
+
+  m_file.write("TSOFRES1", 8);
+  m_file.write(reinterpret_cast<const char*>(&objectiveCount), sizeof(qint32));
+  m_file.write(reinterpret_cast<const char*>(&geometryCount), sizeof(qint32));
+  m_file.write(reinterpret_cast<const char*>(&metricCount), sizeof(qint32));
+  m_file.write(reinterpret_cast<const char*>(&recordSize), sizeof(qint32));
+  m_file.write(reinterpret_cast<const char*>(&dataOffset), sizeof(qint32));
+  m_file.write(names);
+  m_file.flush();
+
+  return true;
+}
+
+void ResultWriter::writeBinary(Record *records)
+{
+  QByteArray runId(m_runIdSize, '\0');
+
+  for(Record *record = records; record; record = record->next)
+  {
+    QByteArray name = record->runId.toUtf8().left(m_runIdSize - 1);
+    std::fill(runId.begin(), runId.end(), '\0');
+    std::copy(name.begin(), name.end(), runId.begin());
+
+    qint32 iteration = record->iteration;
+    qint32 kind = record->snapshot ? 1 : 0;
+
+    blockValues(record->values, m_block);
+
+    m_file.write(runId);
+    m_file.write(reinterpret_cast<const char*>(&iteration), sizeof(qint32));
+    m_file.write(reinterpret_cast<const char*>(&kind), sizeof(qint32));
+    m_file.write(reinterpret_cast<const char*>(&record->dateTime), sizeof(double));
+    m_file.write(reinterpret_cast<const char*>(m_block.data()), sizeof(double) * m_block.size());
+  }
+
+  m_file.flush();
+}
+
+void ResultWriter::blockValues(const std::vector<double> &values, std::vector<double> &block) const
+{
+  size_t geometryCount = m_layout.geometryCount();
+  size_t metricCount = m_layout.metrics.size();
+
+  block.assign(m_layout.objectives.size() * geometryCount * metricCount, std::numeric_limits<double>::quiet_NaN());
+
+  size_t index = 0;
+
+  for(const ResultLayout::Column &column : m_layout.columns)
+  {
+    for(int g = 0; g < column.geometryCount && index < values.size(); g++, index++)
+    {
+      block[(column.objective * geometryCount + g) * metricCount + column.metric] = values[index];
+    }
+  }
+}
+
+#ifdef USE_NETCDF
+
+bool ResultWriter::openNetCDF()
+{
+  size_t objectiveCount = m_layout.objectives.size();
+  size_t geometryCount = std::max(1, m_layout.geometryCount());
+  size_t metricCount = m_layout.metrics.size();
+  double missingValue = std::numeric_limits<double>::quiet_NaN();
+
+  QMutexLocker locker(&netCDFMutex());
+
+  try
+  {
+    m_ncFile = new NcFile(m_file.fileName().toStdString(), NcFile::replace, NcFile::nc4);
+
+    NcDim iterationDim = m_ncFile->addDim("iteration");
+    NcDim snapshotDim = m_ncFile->addDim("snapshot");
+    NcDim objectiveDim = m_ncFile->addDim("objective", objectiveCount);
+    NcDim geometryDim = m_ncFile->addDim("geometry", geometryCount);
+    NcDim metricDim = m_ncFile->addDim("metric", metricCount);
+
+    NcVar objectiveVar = m_ncFile->addVar("objective", ncString, objectiveDim);
+    objectiveVar.putAtt("long_name", "Objective");
+
+    for(size_t i = 0; i < objectiveCount; i++)
+    {
+      objectiveVar.putVar(std::vector<size_t>({i}), m_layout.objectives[static_cast<int>(i)].toStdString());
+    }
+
+    NcVar metricVar = m_ncFile->addVar("metric", ncString, metricDim);
+    metricVar.putAtt("long_name", "Objective function metric");
+
+    for(size_t i = 0; i < metricCount; i++)
+    {
+      metricVar.putVar(std::vector<size_t>({i}), m_layout.metrics[static_cast<int>(i)].toStdString());
+    }
+
+    NcVar geometryCountVar = m_ncFile->addVar("geometry_count", ncInt, objectiveDim);
+    geometryCountVar.putAtt("long_name", "Number of geometries of the objective");
+
+    std::vector<int> geometryCounts(objectiveCount, 0);
+
+    for(const ResultLayout::Column &column : m_layout.columns)
+    {
+      geometryCounts[column.objective] = column.geometryCount;
+    }
+
+    if(objectiveCount)
+    {
+      geometryCountVar.putVar(geometryCounts.data());
+    }
+
+    m_ncFile->addVar("run_id", ncString, iterationDim).putAtt("long_name", "Run identifier");
+    m_ncFile->addVar("run_iteration", ncInt, iterationDim).putAtt("long_name", "Iteration of the run");
+
+    m_ncFile->addVar("snapshot_run_id", ncString, snapshotDim).putAtt("long_name", "Run identifier");
+    m_ncFile->addVar("snapshot_iteration", ncInt, snapshotDim).putAtt("long_name", "Iteration of the run");
+
+    NcVar snapshotTimeVar = m_ncFile->addVar("snapshot_time", ncDouble, snapshotDim);
+    snapshotTimeVar.putAtt("long_name", "Snapshot time");
+    snapshotTimeVar.putAtt("units", "days since -4713-01-01 12:00:00");
+
+    //Each iteration is written as one chunk so that rows are appended without rewriting earlier chunks.
+    std::vector<size_t> chunkSizes({1, std::max<size_t>(1, objectiveCount), geometryCount, std::max<size_t>(1, metricCount)});
+
+    NcVar valueVar = m_ncFile->addVar("value", ncDouble, std::vector<NcDim>({iterationDim, objectiveDim, geometryDim, metricDim}));
+    valueVar.setChunking(NcVar::nc_CHUNKED, chunkSizes);
+    valueVar.setFill(true, missingValue);
+    valueVar.putAtt("long_name", "Objective function value");
+
+    NcVar snapshotValueVar = m_ncFile->addVar("snapshot_value", ncDouble, std::vector<NcDim>({snapshotDim, objectiveDim, geometryDim, metricDim}));
+    snapshotValueVar.setChunking(NcVar::nc_CHUNKED, chunkSizes);
+    snapshotValueVar.setFill(true, missingValue);
+    snapshotValueVar.putAtt("long_name", "Objective function value at an intermediate time");
+
+    m_ncFile->sync();
+  }
+  catch(NcException &)
+  {
+    delete m_ncFile;
+    m_ncFile = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+void ResultWriter::writeNetCDF(Record *records)
+{
+  size_t objectiveCount = m_layout.objectives.size();
+  size_t geometryCount = std::max(1, m_layout.geometryCount());
+  size_t metricCount = m_layout.metrics.size();
+
+  QMutexLocker locker(&netCDFMutex());
+
+  try
+  {
+    NcVar runIdVar = m_ncFile->getVar("run_id");
+    NcVar runIterationVar = m_ncFile->getVar("run_iteration");
+    NcVar valueVar = m_ncFile->getVar("value");
+    NcVar snapshotRunIdVar = m_ncFile->getVar("snapshot_run_id");
+    NcVar snapshotIterationVar = m_ncFile->getVar("snapshot_iteration");
+    NcVar snapshotTimeVar = m_ncFile->getVar("snapshot_time");
+    NcVar snapshotValueVar = m_ncFile->getVar("snapshot_value");
+
+    for(Record *record = records; record; record = record->next)
+    {
+      size_t &index = record->snapshot ? m_snapshotCount : m_rowCount;
+      std::vector<size_t> start({index});
+
+      blockValues(record->values, m_block);
+
+      if(record->snapshot)
+      {
+        snapshotRunIdVar.putVar(start, record->runId.toStdString());
+        snapshotIterationVar.putVar(start, record->iteration);
+        snapshotTimeVar.putVar(start, record->dateTime);
+      }
+      else
+      {
+        runIdVar.putVar(start, record->runId.toStdString());
+        runIterationVar.putVar(start, record->iteration);
+      }
+
+      if(m_block.size())
+      {
+        (record->snapshot ? snapshotValueVar : valueVar).putVar(std::vector<size_t>({index, 0, 0, 0}),
+                                                                std::vector<size_t>({1, objectiveCount, geometryCount, metricCount}),
+                                                                m_block.data());
+      }
+
+      index++;
+    }
+
+    m_ncFile->sync();
+  }
+  catch(NcException &e)
+  {
+    qWarning("Unable to write results to %s: %s", qPrintable(m_file.fileName()), e.what());
+  }
+}
+
+#endif
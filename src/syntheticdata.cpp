@@ -0,0 +1,203 @@
+#include "stdafx.h"
+#include "syntheticdata.h"
+#include "temporal/timedata.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <cmath>
+#include <random>
+
+#include "gdal.h"
+#include "ogr_api.h"
+
+namespace
+{
+  QDateTime startQDateTime()
+  {
+    return QDateTime(QDate(2018, 1, 1), QTime(0, 0, 0));
+  }
+}
+
+bool SyntheticData::generate(const SyntheticDataOptions &options, const QString &directory,
+                             QString &inputFile, QString &geometryFile, QString &error)
+{
+  if(options.timeSteps < 2 || options.geometries < 1 || options.stepRatio < 1 ||
+     options.gapDensity < 0.0 || options.gapDensity >= 1.0 || options.observationStep <= 0.0)
+  {
+    error = "Invalid synthetic data options";
+    return false;
+  }
+
+  QDir dir(directory);
+  QString observationFile = dir.absoluteFilePath("observations.csv");
+  geometryFile = dir.absoluteFilePath("geometries.shp");
+  inputFile = dir.absoluteFilePath("objectives.inp");
+
+  return writeGeometries(options, geometryFile, error) &&
+      writeObservations(options, observationFile, error) &&
+      writeInputFile(options, inputFile, observationFile, geometryFile, error);
+}
+
+double SyntheticData::startDateTime()
+{
+  return SDKTemporal::DateTime::toJulianDays(startQDateTime());
+}
+
+double SyntheticData::endDateTime(const SyntheticDataOptions &options)
+{
+  return startDateTime() + (options.timeSteps - 1) * options.observationStep;
+}
+
+double SyntheticData::simulatedValue(int geometryIndex, double julianDay)
+{
+  //A daily cycle with a phase and baseflow that differ per geometry.
+  double phase = 0.1 * (geometryIndex % 64);
+  return 10.0 + 0.01 * (geometryIndex % 100) + 5.0 * sin(2.0 * M_PI * julianDay + phase);
+}
+
+bool SyntheticData::writeGeometries(const SyntheticDataOptions &options, const QString &filePath, QString &error)
+{
+  GDALAllRegister();
+
+  GDALDriverH driver = GDALGetDriverByName("ESRI Shapefile");
+
+  if(!driver)
+  {
+    error = "ESRI Shapefile driver is not available";
+    return false;
+  }
+
+  if(QFile::exists(filePath))
+  {
+    GDALDeleteDataset(driver, filePath.toStdString().c_str());
+  }
+
+  GDALDatasetH dataset = GDALCreate(driver, filePath.toStdString().c_str(), 0, 0, 0, GDT_Unknown, nullptr);
+
+  if(!dataset)
+  {
+    error = "Unable to create shapefile: " + filePath;
+    return false;
+  }
+
+  OGRLayerH layer = GDALDatasetCreateLayer(dataset, "geometries", nullptr, wkbLineString, nullptr);
+  bool written = layer != nullptr;
+
+  //Reaches are laid out on a grid of 100 columns, so every geometry has distinct vertices.
+  for(int g = 0; written && g < options.geometries; g++)
+  {
+    double x = 100.0 * (g % 100);
+    double y = 100.0 * (g / 100);
+
+    OGRFeatureH feature = OGR_F_Create(OGR_L_GetLayerDefn(layer));
+    OGRGeometryH lineString = OGR_G_CreateGeometry(wkbLineString);
+    OGR_G_AddPoint_2D(lineString, x, y);
+    OGR_G_AddPoint_2D(lineString, x + 25.0, y + 10.0);
+    OGR_G_AddPoint_2D(lineString, x + 50.0, y);
+    OGR_F_SetGeometryDirectly(feature, lineString);
+
+    written = OGR_L_CreateFeature(layer, feature) == OGRERR_NONE;
+
+    OGR_F_Destroy(feature);
+  }
+
+  GDALClose(dataset);
+
+  if(!written)
+  {
+    error = "Unable to write shapefile: " + filePath;
+  }
+
+  return written;
+}
+
+bool SyntheticData::writeObservations(const SyntheticDataOptions &options, const QString &filePath, QString &error)
+{
+  QFile file(filePath);
+
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    error = "Unable to write observation file: " + filePath;
+    return false;
+  }
+
+  QTextStream stream(&file);
+  stream.setRealNumberNotation(QTextStream::FixedNotation);
+
+  stream << "DateTime";
+
+  for(int g = 0; g < options.geometries; g++)
+  {
+    stream << ", G" << g;
+  }
+
+  stream << "\n";
+
+  std::mt19937 generator(options.seed);
+  std::uniform_real_distribution<double> gapDistribution(0.0, 1.0);
+  std::normal_distribution<double> noiseDistribution(0.0, 0.25);
+
+  double startTime = startDateTime();
+
+  for(int t = 0; t < options.timeSteps; t++)
+  {
+    //The first and last times are always observed so that the observations span the horizon.
+    if(t > 0 && t < options.timeSteps - 1 && gapDistribution(generator) < options.gapDensity)
+      continue;
+
+    double julianDay = startTime + t * options.observationStep;
+
+    stream.setRealNumberPrecision(10);
+    stream << julianDay;
+    stream.setRealNumberPrecision(6);
+
+    for(int g = 0; g < options.geometries; g++)
+    {
+      stream << ", " << simulatedValue(g, julianDay) + noiseDistribution(generator);
+    }
+
+    stream << "\n";
+  }
+
+  stream.flush();
+  file.close();
+
+  return true;
+}
+
+bool SyntheticData::writeInputFile(const SyntheticDataOptions &options, const QString &filePath,
+                                   const QString &observationFile, const QString &geometryFile, QString &error)
+{
+  QFile file(filePath);
+
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    error = "Unable to write input file: " + filePath;
+    return false;
+  }
+
+  QDateTime start = startQDateTime();
+  QDateTime end = start.addMSecs(qRound64((options.timeSteps - 1) * options.observationStep * 86400000.0));
+
+  QTextStream stream(&file);
+
+  stream << ";; Synthetic benchmark problem: " << options.timeSteps << " time steps, "
+         << options.geometries << " geometries, step ratio " << options.stepRatio
+         << ", gap density " << options.gapDensity << "\n"
+         << "[OPTIONS]\n"
+         << "START_DATETIME " << start.toString("yyyy-MM-dd hh:mm:ss") << "\n"
+         << "END_DATETIME " << end.toString("yyyy-MM-dd hh:mm:ss") << "\n"
+         << "RETAIN_HISTORY NO\n"
+         << "[OBJECTIVES]\n"
+         << "Synthetic NASH_SUTCLIFF|RMSE|MAE|KGE|PBIAS|LOG_NASH_SUTCLIFF|R2 " << observationFile << " Synthetic\n"
+         << "[OBJECTIVE_GEOMETRIES]\n"
+         << "Synthetic SHAPEFILE " << geometryFile << "\n";
+
+  stream.flush();
+  file.close();
+
+  return true;
+}
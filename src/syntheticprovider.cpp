@@ -0,0 +1,266 @@
+#include "stdafx.h"
+#include "syntheticprovider.h"
+#include "geometrystore.h"
+#include "hydrocouplespatial.h"
+#include "hydrocoupletemporal.h"
+#include "core/dimension.h"
+#include "core/valuedefinition.h"
+#include "temporal/timedata.h"
+
+using namespace HydroCouple;
+using namespace HydroCouple::Spatial;
+using namespace HydroCouple::Temporal;
+
+SyntheticProviderComponentInfo::SyntheticProviderComponentInfo(QObject *parent)
+  : AbstractModelComponentInfo(parent)
+{
+  setId("Synthetic Provider 1.0.0");
+  setCaption("Synthetic Provider Component");
+  setDescription("A stand-in model that reports synthetic values for benchmarking the objective function component");
+  setCategory("Parameter Estimation & Uncertainty");
+  setVersion("1.0.0");
+}
+
+SyntheticProviderComponentInfo::~SyntheticProviderComponentInfo()
+{
+
+}
+
+HydroCouple::IModelComponent *SyntheticProviderComponentInfo::createComponentInstance()
+{
+  QString id =  QUuid::createUuid().toString();
+  SyntheticProviderComponent *component = new SyntheticProviderComponent(id, this);
+  component->setDescription("Synthetic Provider Model Instance");
+  return component;
+}
+
+SyntheticProviderOutput::SyntheticProviderOutput(const QString &id,
+                                                 Dimension *timeDimension,
+                                                 Dimension *geometryDimension,
+                                                 ValueDefinition *valueDefinition,
+                                                 SyntheticProviderComponent *component)
+  : TimeGeometryOutputDouble(id, IGeometry::LineString, timeDimension, geometryDimension, valueDefinition, component),
+    m_component(component)
+{
+
+}
+
+SyntheticProviderOutput::~SyntheticProviderOutput()
+{
+
+}
+
+void SyntheticProviderOutput::updateValues(HydroCouple::IInput *querySpecifier)
+{
+  if(!m_component->workflow())
+  {
+    ITimeComponentDataItem* timeExchangeItem = dynamic_cast<ITimeComponentDataItem*>(querySpecifier);
+    QList<IOutput*> updateList;
+    updateList.append(this);
+
+    if(timeExchangeItem)
+    {
+      double queryTime = timeExchangeItem->time(timeExchangeItem->timeCount() - 1)->julianDay();
+
+      while (m_component->currentDateTime()->julianDay() < queryTime &&
+             m_component->status() == IModelComponent::Updated)
+      {
+        m_component->update(updateList);
+      }
+    }
+    else
+    {
+      if(m_component->status() == IModelComponent::Updated)
+      {
+        m_component->update(updateList);
+      }
+    }
+  }
+
+  refreshAdaptedOutputs();
+}
+
+void SyntheticProviderOutput::updateValues()
+{
+
+}
+
+void SyntheticProviderOutput::advance(double julianDay)
+{
+  int numGeometries = geometryCount();
+
+  if(timeCount() < 2)
+  {
+    addTime(new SDKTemporal::DateTime(julianDay, nullptr));
+  }
+  else
+  {
+    dynamic_cast<SDKTemporal::DateTime*>(time(0))->setJulianDay(time(1)->julianDay());
+    dynamic_cast<SDKTemporal::DateTime*>(time(1))->setJulianDay(julianDay);
+
+    for(int g = 0; g < numGeometries; g++)
+    {
+      setValue(0, g, &m_values[g]);
+    }
+  }
+
+  int currentTimeIndex = timeCount() - 1;
+  m_values.resize(numGeometries);
+
+  for(int g = 0; g < numGeometries; g++)
+  {
+    m_values[g] = SyntheticData::simulatedValue(g, julianDay);
+    setValue(currentTimeIndex, g, &m_values[g]);
+  }
+}
+
+SyntheticProviderComponent::SyntheticProviderComponent(const QString &id, SyntheticProviderComponentInfo *modelComponentInfo)
+  : AbstractTimeModelComponent(id, modelComponentInfo),
+    m_output(nullptr),
+    m_timeStep(0.0),
+    m_stepCount(0)
+{
+  m_timeDimension = new Dimension("TimeDimension",this);
+  m_geometryDimension = new Dimension("ElementGeometryDimension", this);
+
+  createArguments();
+}
+
+SyntheticProviderComponent::~SyntheticProviderComponent()
+{
+
+}
+
+void SyntheticProviderComponent::setSyntheticData(const SyntheticDataOptions &options, const QString &geometryFile)
+{
+  m_options = options;
+  m_geometryFile = geometryFile;
+}
+
+QList<QString> SyntheticProviderComponent::validate()
+{
+  return QList<QString>();
+}
+
+void SyntheticProviderComponent::prepare()
+{
+  if(!isPrepared() && isInitialized())
+  {
+    m_stepCount = 0;
+    currentDateTimeInternal()->setJulianDay(timeHorizon()->julianDay());
+    m_output->advance(timeHorizon()->julianDay());
+
+    setStatus(IModelComponent::Updated ,"Finished preparing model");
+    setPrepared(true);
+  }
+  else
+  {
+    setPrepared(false);
+    setStatus(IModelComponent::Failed ,"Error occured when preparing model");
+  }
+}
+
+void SyntheticProviderComponent::update(const QList<HydroCouple::IOutput *> &requiredOutputs)
+{
+  Q_UNUSED(requiredOutputs)
+
+  if(status() == IModelComponent::Updated)
+  {
+    setStatus(IModelComponent::Updating);
+
+    m_stepCount++;
+
+    //Times are computed from the step count so that they do not drift over long runs.
+    double nextDateTime = timeHorizon()->julianDay() + m_stepCount * m_timeStep;
+    m_output->advance(nextDateTime);
+
+    currentDateTimeInternal()->setJulianDay(nextDateTime);
+
+    if(nextDateTime >= timeHorizon()->julianDay() + timeHorizon()->duration())
+    {
+      setStatus(IModelComponent::Done , "Simulation finished successfully", 100);
+    }
+    else
+    {
+      setStatus(IModelComponent::Updated);
+    }
+  }
+}
+
+void SyntheticProviderComponent::finish()
+{
+  if(isPrepared())
+  {
+    setStatus(IModelComponent::Finishing , "SyntheticProviderComponent with id " + id() + " is being disposed" , 100);
+
+    initializeFailureCleanUp();
+
+    setPrepared(false);
+    setInitialized(false);
+
+    setStatus(IModelComponent::Finished , "SyntheticProviderComponent with id " + id() + " has been disposed" , 100);
+  }
+}
+
+SyntheticProviderOutput *SyntheticProviderComponent::output() const
+{
+  return m_output;
+}
+
+double SyntheticProviderComponent::timeStep() const
+{
+  return m_timeStep;
+}
+
+int SyntheticProviderComponent::stepCount() const
+{
+  return m_stepCount;
+}
+
+void SyntheticProviderComponent::initializeFailureCleanUp()
+{
+  m_output = nullptr;
+  m_geometrySet.clear();
+}
+
+void SyntheticProviderComponent::createArguments()
+{
+
+}
+
+bool SyntheticProviderComponent::initializeArguments(QString &message)
+{
+  message = "";
+
+  m_geometrySet = GeometryStore::shapefileGeometries(QFileInfo(m_geometryFile), message);
+
+  if(m_geometrySet.isNull())
+    return false;
+
+  m_timeStep = m_options.observationStep / m_options.stepRatio;
+
+  //The horizon extends one step past the last observation so that it is always bracketed by provider values.
+  double startDateTime = SyntheticData::startDateTime();
+  timeHorizonInternal()->setJulianDay(startDateTime);
+  timeHorizonInternal()->setDuration(SyntheticData::endDateTime(m_options) - startDateTime + m_timeStep);
+  currentDateTimeInternal()->setJulianDay(startDateTime);
+
+  return true;
+}
+
+void SyntheticProviderComponent::createInputs()
+{
+
+}
+
+void SyntheticProviderComponent::createOutputs()
+{
+  Quantity *quantity = Quantity::unitLessValues("Unitless", QVariant::Double, this);
+
+  m_output = new SyntheticProviderOutput("SyntheticValues", m_timeDimension, m_geometryDimension, quantity, this);
+  m_output->addGeometries(m_geometrySet->geometries());
+  m_output->setCaption("Synthetic Values");
+  m_output->setDescription("Synthetic Values");
+
+  addOutput(m_output);
+}
@@ -7,19 +7,92 @@
 #include "core/abstractoutput.h"
 #include "temporal/timedata.h"
 #include "progresschecker.h"
-#include "spatial/envelope.h"
-#include "spatial/geometryfactory.h"
 #include "objectiveinput.h"
 #include "objectiveoutput.h"
+#include "objectivestatisticsarray.h"
+#include "observationseries.h"
+#include "observationstore.h"
+#include "geometrystore.h"
+#include "providergeometryindex.h"
+#include "resultwriter.h"
 
 #include <QTextStream>
+#include <algorithm>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 
 using namespace std;
 
+namespace
+{
+  /*!
+   * \brief mpiRank
+   * \param rank
+   * \param size
+   * \return True if MPI is initialized and running.
+   */
+  bool mpiRank(int &rank, int &size)
+  {
+    rank = 0;
+    size = 1;
+
+#ifdef USE_MPI
+    int initialized = 0, finalized = 0;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+
+    if(initialized && !finalized)
+    {
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+      MPI_Comm_size(MPI_COMM_WORLD, &size);
+      return true;
+    }
+#endif
+
+    return false;
+  }
+
+#ifdef USE_MPI
+  //Rows of ensemble members are sent to rank 0 as packed values followed by their newline separated run ids.
+  const int ensembleValuesTag = 7301;
+  const int ensembleRunIdsTag = 7302;
+#endif
+
+  /*!
+   * \brief outputFileArguments
+   * \return Identifiers of the output file arguments and the formats they are written in.
+   */
+  const std::vector<std::pair<QString, ResultWriter::Format>> &outputFileArguments()
+  {
+    static const std::vector<std::pair<QString, ResultWriter::Format>> arguments({
+                                                                                   {"Output CSV File", ResultWriter::CSV},
+                                                                                   {"Output NetCDF File", ResultWriter::NetCDF},
+                                                                                   {"Output Binary File", ResultWriter::Binary},
+                                                                                 });
+    return arguments;
+  }
+}
+
 TSObjectiveFunctionComponent::TSObjectiveFunctionComponent(const QString &id, TSObjectiveFunctionComponentInfo *modelComponentInfo)
   : AbstractTimeModelComponent(id, modelComponentInfo),
     m_parent(nullptr),
-    m_inputFilesArgument(nullptr)
+    m_inputFilesArgument(nullptr),
+    m_retainHistory(true),
+    m_statisticsKernel(ObjectiveStatisticsArray::Automatic),
+    m_observationCache(true),
+    m_batchUpdate(false),
+    m_clonePool(false),
+    m_distributedMode(Local),
+    m_timeTolerance(m_defaultTimeTolerance),
+    m_snapshotInterval(0.0),
+    m_nextSnapshotTime(0.0),
+    m_pruned(false),
+    m_runningOutputSteps(0),
+    m_stepCount(0),
+    m_iteration(0),
+    m_finishedEnsembleRanks(0)
 {
   m_timeDimension = new Dimension("TimeDimension",this);
   m_geometryDimension = new Dimension("ElementGeometryDimension", this);
@@ -63,6 +136,10 @@ void TSObjectiveFunctionComponent::prepare()
 
     progressChecker()->reset(m_startDate, m_endDate);
 
+    m_nextSnapshotTime = m_startDate + m_snapshotInterval;
+    m_pruned = false;
+    m_stepCount = 0;
+
     updateOutputValues(QList<HydroCouple::IOutput*>());
 
     setStatus(IModelComponent::Updated ,"Finished preparing model");
@@ -81,26 +158,64 @@ void TSObjectiveFunctionComponent::update(const QList<HydroCouple::IOutput *> &r
   {
     setStatus(IModelComponent::Updating);
 
+    m_stepCount++;
+
     applyInputValues();
 
+    //Batch updates may have advanced inputs past other inputs.
+    sortUpdateOrder();
+
     double minDate = getMinDate();
+    QString pruneMessage;
+    bool evaluated = true;
+
+    if(minDate < m_endDate && pruneThresholdExceeded(pruneMessage))
+    {
+      m_pruned = true;
+
+      for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+      {
+        objectiveOutput->prune();
+      }
+    }
+    else if(minDate >= m_endDate)
+    {
+      evaluated = evaluateObjectives();
+    }
 
     updateOutputValues(requiredOutputs);
 
     currentDateTimeInternal()->setJulianDay(minDate);
 
-    if(minDate >=  m_endDate)
+    if(m_pruned)
+    {
+      writeOutput();
+      setStatus(IModelComponent::Done , "Simulation pruned | " + pruneMessage, 100);
+    }
+    else if(minDate >= m_endDate && !evaluated)
+    {
+      //Objectives of a single partition would be written as if they covered the whole domain.
+      setStatus(IModelComponent::Failed , "Objective statistics could not be reduced across MPI ranks");
+    }
+    else if(minDate >=  m_endDate)
     {
       writeOutput();
       setStatus(IModelComponent::Done , "Simulation finished successfully", 100);
     }
     else
     {
+      if(m_snapshotInterval > 0.0 && minDate >= m_nextSnapshotTime)
+      {
+        writeSnapshot(minDate);
+      }
+
       for(ObjectiveInput *input : m_objectiveInputs)
       {
         input->moveToNextDateTime();
       }
 
+      sortUpdateOrder();
+
       if(progressChecker()->performStep(minDate))
       {
         setStatus(IModelComponent::Updated , "Simulation performed time-step | DateTime: " + QString::number(minDate, 'f') , progressChecker()->progress());
@@ -115,11 +230,37 @@ void TSObjectiveFunctionComponent::update(const QList<HydroCouple::IOutput *> &r
 
 void TSObjectiveFunctionComponent::finish()
 {
-  if(isPrepared())
+  //Rows still buffered are flushed once per parent, which is the only collective point of an ensemble run.
+  if(!m_parent && m_distributedMode == Ensemble)
+  {
+    finishEnsembleRows();
+  }
+
+  //Pooled clones are rewound and parked with their parent instead of being torn down.
+  if(isPrepared() && m_parent && m_parent->m_clonePool)
+  {
+    setStatus(IModelComponent::Finishing , "TSObjectiveFunctionComponent with id " + id() + " is being returned to the clone pool" , 100);
+
+    reset();
+
+#ifdef USE_OPENMP
+#pragma omp critical (TSObjectiveFunctionComponent)
+#endif
+    {
+      if(!m_parent->m_pooledClones.contains(this))
+      {
+        m_parent->m_pooledClones.append(this);
+      }
+    }
+
+    setStatus(IModelComponent::Finished , "TSObjectiveFunctionComponent with id " + id() + " has been returned to the clone pool" , 100);
+  }
+  else if(isPrepared())
   {
     setStatus(IModelComponent::Finishing , "TSObjectiveFunctionComponent with id " + id() + " is being disposed" , 100);
 
-    initializeFailureCleanUp();
+    //Parsed inputs are kept so that the next initialization only reloads sources that changed.
+    releaseRuntimeState();
 
     setPrepared(false);
     setInitialized(false);
@@ -136,6 +277,36 @@ HydroCouple::ICloneableModelComponent *TSObjectiveFunctionComponent::parent() co
 
 HydroCouple::ICloneableModelComponent *TSObjectiveFunctionComponent::clone()
 {
+  QFileInfo pooledInputFile = getAbsoluteFilePath(QString((*m_inputFilesArgument)["Input File"]));
+
+  while (isInitialized())
+  {
+    TSObjectiveFunctionComponent *pooledClone = nullptr;
+
+#ifdef USE_OPENMP
+#pragma omp critical (TSObjectiveFunctionComponent)
+#endif
+    {
+      if(m_pooledClones.size())
+      {
+        pooledClone = m_pooledClones.takeFirst();
+      }
+    }
+
+    if(!pooledClone)
+      break;
+
+    //Clones returned to the pool keep their observations, geometries and provider links and only need rewinding.
+    //Clones that loaded an earlier version of the input file, observations or geometries are discarded instead.
+    if(pooledClone->sourcesUnchanged(pooledInputFile))
+    {
+      pooledClone->reset();
+      return pooledClone;
+    }
+
+    discardClone(pooledClone);
+  }
+
   if(isInitialized())
   {
     TSObjectiveFunctionComponent *cloneComponent = dynamic_cast<TSObjectiveFunctionComponent*>(componentInfo()->createComponentInstance());
@@ -150,29 +321,24 @@ HydroCouple::ICloneableModelComponent *TSObjectiveFunctionComponent::clone()
 
     QString appendName = "_clone_" + QString::number(m_clones.size()) + "_" + QUuid::createUuid().toString().replace("{","").replace("}","");
 
-    //(*cloneComponent->m_inputFilesArgument)["Input File"] = QString((*m_inputFilesArgument)["Input File"]);
-
+    //Clones read the parent's input file in place. Observations are shared through the ObservationStore,
+    //so nothing needs to be copied or read again.
     QString inputFilePath = QString((*m_inputFilesArgument)["Input File"]);
     QFileInfo inputFile = getAbsoluteFilePath(inputFilePath);
+    (*cloneComponent->m_inputFilesArgument)["Input File"] = inputFile.absoluteFilePath();
 
-    if(inputFile.absoluteDir().exists())
+    //Clones append their rows to the parent's output files through the shared result writers.
+    for(const auto &outputFileArgument : outputFileArguments())
     {
-      QString suffix = "." + inputFile.completeSuffix();
-      inputFilePath = inputFile.absoluteFilePath().replace(suffix,"") + appendName + suffix;
-      QFile::copy(inputFile.absoluteFilePath(), inputFilePath);
-      (*cloneComponent->m_inputFilesArgument)["Input File"] = inputFilePath;
-    }
+      QString outputFilePath = QString((*m_inputFilesArgument)[outputFileArgument.first]);
 
-    QString  outputCSVFilePath = QString((*m_inputFilesArgument)["Output CSV File"]);
-    QFileInfo outputCSVFile = getAbsoluteFilePath(outputCSVFilePath);
-
-    if(!outputCSVFilePath.isEmpty() && outputCSVFile.absoluteDir().exists())
-    {
-      QString suffix = "." + outputCSVFile.completeSuffix();
-      outputCSVFilePath = outputCSVFile.absoluteFilePath().replace(suffix,"") + appendName + suffix;
-      (*cloneComponent->m_inputFilesArgument)["Output CSV File"] = outputCSVFilePath;
+      if(!outputFilePath.isEmpty())
+      {
+        (*cloneComponent->m_inputFilesArgument)[outputFileArgument.first] = getAbsoluteFilePath(outputFilePath).absoluteFilePath();
+      }
     }
 
+    cloneComponent->m_runId = runId() + appendName;
 
     cloneComponent->m_parent = this;
     m_clones.append(cloneComponent);
@@ -192,28 +358,103 @@ QList<HydroCouple::ICloneableModelComponent*> TSObjectiveFunctionComponent::clon
   return m_clones;
 }
 
+bool TSObjectiveFunctionComponent::reset()
+{
+  if(!isInitialized())
+    return false;
+
+  for(ObjectiveInput *objectiveInput : m_objectiveInputs)
+  {
+    objectiveInput->reset();
+  }
+
+  for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+  {
+    objectiveOutput->reset();
+  }
+
+  for(size_t i = 0; i < m_updateOrder.size(); i++)
+  {
+    m_updateOrder[i] = static_cast<int>(i);
+  }
+
+  m_updatedProviders.clear();
+  sortUpdateOrder();
+
+  //Providers of the next run may be allocated at the addresses of the providers of this run.
+  m_providerGeometryIndexes.clear();
+
+  m_pruned = false;
+  m_stepCount = 0;
+  currentDateTimeInternal()->setJulianDay(m_startDate);
+
+  setPrepared(false);
+  setStatus(IModelComponent::Initialized, "TSObjectiveFunctionComponent with id " + id() + " has been reset");
+
+  return true;
+}
+
 void TSObjectiveFunctionComponent::applyInputValues()
 {
-  std::map<double, std::list<int>> updateOrder;
+  //Inputs are visited in order of their current observation time. Inputs linked to the same provider at
+  //the same time share a single pull and read the values from the provider's time buffer in applyData.
+  m_updatedProviders.clear();
 
-  for(size_t i = 0; i < m_objectiveInputs.size(); i++)
+  for(int i : m_updateOrder)
   {
     ObjectiveInput *objectiveInput = m_objectiveInputs[i];
-    double time = objectiveInput->time(objectiveInput->timeCount() - 1)->julianDay();
-    updateOrder[time].push_back(i);
+    std::pair<HydroCouple::IOutput*, double> providerTime(objectiveInput->provider(), objectiveInput->currentDateTime());
+
+    if(m_updatedProviders.size() && m_updatedProviders.back().second != providerTime.second)
+    {
+      m_updatedProviders.clear();
+    }
+
+    if(std::find(m_updatedProviders.begin(), m_updatedProviders.end(), providerTime) == m_updatedProviders.end())
+    {
+      objectiveInput->retrieveValuesFromProvider();
+      m_updatedProviders.push_back(providerTime);
+    }
+    else
+    {
+      objectiveInput->prepareRetrieval();
+    }
+
+    objectiveInput->applyData();
   }
+}
+
+QSharedPointer<ProviderGeometryIndex> TSObjectiveFunctionComponent::providerGeometryIndex(HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem *provider)
+{
+  QSharedPointer<ProviderGeometryIndex> &geometryIndex = m_providerGeometryIndexes[provider];
 
-  for(auto it = updateOrder.begin(); it != updateOrder.end(); it++)
+  if(geometryIndex.isNull() || geometryIndex->geometryCount() != provider->geometryCount())
   {
-    std::list<int> list = it->second;
+    geometryIndex = QSharedPointer<ProviderGeometryIndex>(new ProviderGeometryIndex(provider));
+  }
 
-    for(int i : list)
+  return geometryIndex;
+}
+
+void TSObjectiveFunctionComponent::releaseProviderGeometryIndex(HydroCouple::SpatioTemporal::ITimeGeometryComponentDataItem *provider)
+{
+  m_providerGeometryIndexes.erase(provider);
+}
+
+void TSObjectiveFunctionComponent::discardClone(TSObjectiveFunctionComponent *component)
+{
+  for(ObjectiveInput *objectiveInput : component->m_objectiveInputs)
+  {
+    if(objectiveInput->provider())
     {
-      ObjectiveInput *objectiveInput = m_objectiveInputs[i];
-      objectiveInput->retrieveValuesFromProvider();
-      objectiveInput->applyData();
+      objectiveInput->provider()->removeConsumer(objectiveInput);
     }
+
+    objectiveInput->setProvider(nullptr);
   }
+
+  removeClone(component);
+  delete component;
 }
 
 bool TSObjectiveFunctionComponent::removeClone(TSObjectiveFunctionComponent *component)
@@ -225,6 +466,7 @@ bool TSObjectiveFunctionComponent::removeClone(TSObjectiveFunctionComponent *com
 #endif
   {
     removed = m_clones.removeAll(component);
+    m_pooledClones.removeAll(component);
   }
 
 
@@ -239,26 +481,30 @@ bool TSObjectiveFunctionComponent::removeClone(TSObjectiveFunctionComponent *com
 
 void TSObjectiveFunctionComponent::initializeFailureCleanUp()
 {
+  releaseRuntimeState();
+
   m_objectiveNames.clear();
+  m_objectiveDesc.clear();
   m_algorithms.clear();
 
-  for(TimeSeries *ts : m_inputTSFiles)
-    delete ts;
-
   m_inputTSFiles.clear();
+  m_inputTSKeys.clear();
+
+  m_geometries.clear();
+  m_geometrySets.clear();
+  m_sourceFiles.clear();
+}
 
+void TSObjectiveFunctionComponent::releaseRuntimeState()
+{
   m_objectiveOutputs.clear();
   m_objectiveInputs.clear();
+  m_updateOrder.clear();
+  m_updatedProviders.clear();
+  m_providerGeometryIndexes.clear();
 
-  if (m_outputCSVStream.device() && m_outputCSVStream.device()->isOpen())
-  {
-    m_outputCSVStream.flush();
-    m_outputCSVStream.device()->close();
-    delete m_outputCSVStream.device();
-    m_outputCSVStream.setDevice(nullptr);
-  }
-
-  m_geometries.clear();
+  //Rows still queued are written once the component and its clones have released the writers.
+  m_resultWriters.clear();
 }
 
 void TSObjectiveFunctionComponent::createArguments()
@@ -270,7 +516,11 @@ void TSObjectiveFunctionComponent::createInputFileArguments()
 {
   QStringList fidentifiers;
   fidentifiers.append("Input File");
-  fidentifiers.append("Output CSV File");
+
+  for(const auto &outputFileArgument : outputFileArguments())
+  {
+    fidentifiers.append(outputFileArgument.first);
+  }
 
   Quantity *fquantity = Quantity::unitLessValues("InputFilesQuantity", QVariant::String, this);
   fquantity->setDefaultValue("");
@@ -290,7 +540,7 @@ bool TSObjectiveFunctionComponent::initializeArguments(QString &message)
 {
   message = "";
 
-  initializeFailureCleanUp();
+  releaseRuntimeState();
 
   bool initialized = initializeInputFilesArguments(message);
 
@@ -304,18 +554,108 @@ bool TSObjectiveFunctionComponent::initializeInputFilesArguments(QString &messag
   QString inputFilePath = (*m_inputFilesArgument)["Input File"];
   QFileInfo inputFile = getAbsoluteFilePath(inputFilePath);
 
+  //Parsed options, observations and geometries are kept from the previous initialization unless one of their sources changed.
+  if(!sourcesUnchanged(inputFile))
+  {
+    //readInputFile clears the members first. These references only keep the previous observations and geometries
+    //alive while it runs, so the stores hand back the loaded objects of unchanged sources instead of reading them again.
+    std::vector<QSharedPointer<ObservationSeries>> previousTimeSeries = m_inputTSFiles;
+    std::vector<QSharedPointer<GeometrySet>> previousGeometrySets = m_geometrySets;
+
+    bool read = readInputFile(inputFile, message);
+
+    Q_UNUSED(previousTimeSeries)
+    Q_UNUSED(previousGeometrySets)
+
+    if(!read)
+    {
+      m_sourceFiles.clear();
+      return false;
+    }
+  }
+
+  int mpiProcessRank, mpiProcessCount;
+
+  if(m_distributedMode != Local && !mpiRank(mpiProcessRank, mpiProcessCount))
+  {
+    message = "MPI_MODE DECOMPOSED and ENSEMBLE require a build with USE_MPI and MPI to be initialized before the component is initialized";
+    return false;
+  }
+
+  m_outputFiles.clear();
+
+  for(const auto &outputFileArgument : outputFileArguments())
+  {
+    QString outputFilePath = (*m_inputFilesArgument)[outputFileArgument.first];
+
+    if(outputFilePath.isEmpty() || outputFilePath.isNull())
+      continue;
+
+    QFileInfo outputFile = getAbsoluteFilePath(outputFilePath);
+
+    if(!outputFile.absoluteDir().exists())
+    {
+      message = "Output file directory does not exist: " + outputFile.absoluteFilePath();
+      return false;
+    }
+
+#ifndef USE_NETCDF
+    if(outputFileArgument.second == ResultWriter::NetCDF)
+    {
+      message = "NetCDF output is not supported by this build: " + outputFile.absoluteFilePath();
+      return false;
+    }
+#endif
+
+    if(!outputFile.isDir())
+    {
+      m_outputFiles.push_back(std::make_pair(outputFile, outputFileArgument.second));
+    }
+  }
+
+  if(m_startDate > m_endDate)
+  {
+    message = "START_DATETIME (" + QString::number(m_startDate, 'f') + " julian days) is after END_DATETIME (" + QString::number(m_endDate, 'f') + " julian days)";
+    return false;
+  }
+
+  timeHorizonInternal()->setJulianDay(m_startDate);
+  timeHorizonInternal()->setDuration(m_endDate - m_startDate);
+
+  return true;
+}
+
+bool TSObjectiveFunctionComponent::readInputFile(const QFileInfo &inputFile, QString &message)
+{
+  m_sourceFiles.clear();
+  m_geometries.clear();
+  m_geometrySets.clear();
+
   m_objectiveNames.clear();
   m_objectiveDesc.clear();
   m_algorithms.clear();
 
-  for(TimeSeries *ts : m_inputTSFiles)
-    delete ts;
-
   m_inputTSFiles.clear();
+  m_inputTSKeys.clear();
+
+  m_retainHistory = true;
+  m_statisticsKernel = ObjectiveStatisticsArray::Automatic;
+  m_timeTolerance = m_defaultTimeTolerance;
+  m_observationCache = true;
+  m_batchUpdate = false;
+  m_clonePool = false;
+  m_distributedMode = Local;
+  m_snapshotInterval = 0.0;
+  m_runningOutputSteps = 0;
+  m_pruneThresholds.clear();
+
+  std::vector<std::string> pruneObjectives;
+  std::vector<QFileInfo> observationFiles;
 
   if(inputFile.isFile() && inputFile.exists() && !inputFile.isDir())
   {
     QFile file(inputFile.absoluteFilePath());
+    addSourceFile(inputFile);
 
     if(file.open(QIODevice::ReadOnly))
     {
@@ -373,6 +713,150 @@ bool TSObjectiveFunctionComponent::initializeInputFilesArguments(QString &messag
                       return false;
                     }
                   }
+                  else if(cols.size() == 2)
+                  {
+                    auto optionIt = m_optionsFlags.find(cols[0].toUpper().toStdString());
+
+                    if(optionIt != m_optionsFlags.cend())
+                    {
+                      switch (optionIt->second)
+                      {
+                        case 3:
+                          {
+                            readSuccess = readBoolean(cols[1], m_retainHistory);
+                          }
+                          break;
+                        case 4:
+                          {
+                            ObjectiveStatisticsArray::Kernel kernel;
+
+                            if((readSuccess = ObjectiveStatisticsArray::tryParseKernel(cols[1], kernel)))
+                            {
+                              m_statisticsKernel = kernel;
+                            }
+                          }
+                          break;
+                        case 5:
+                          {
+                            double timeTolerance = cols[1].toDouble(&readSuccess);
+
+                            if((readSuccess = readSuccess && timeTolerance >= 0.0))
+                            {
+                              m_timeTolerance = timeTolerance / 86400.0;
+                            }
+                          }
+                          break;
+                        case 6:
+                          {
+                            readSuccess = readBoolean(cols[1], m_observationCache);
+                          }
+                          break;
+                        case 7:
+                          {
+                            readSuccess = readBoolean(cols[1], m_batchUpdate);
+                          }
+                          break;
+                        case 9:
+                          {
+                            readSuccess = readBoolean(cols[1], m_clonePool);
+                          }
+                          break;
+                        case 10:
+                          {
+                            double snapshotInterval = cols[1].toDouble(&readSuccess);
+
+                            if((readSuccess = readSuccess && snapshotInterval >= 0.0))
+                            {
+                              m_snapshotInterval = snapshotInterval / 86400.0;
+                            }
+                          }
+                          break;
+                        case 12:
+                          {
+                            int runningOutputSteps = cols[1].toInt(&readSuccess);
+
+                            if((readSuccess = readSuccess && runningOutputSteps >= 0))
+                            {
+                              m_runningOutputSteps = runningOutputSteps;
+                            }
+                          }
+                          break;
+                        case 8:
+                          {
+                            if(!cols[1].compare("NONE", Qt::CaseInsensitive))
+                            {
+                              m_distributedMode = Local;
+                            }
+                            else if(!cols[1].compare("DECOMPOSED", Qt::CaseInsensitive))
+                            {
+                              m_distributedMode = DecomposedDomain;
+                            }
+                            else if(!cols[1].compare("ENSEMBLE", Qt::CaseInsensitive))
+                            {
+                              m_distributedMode = Ensemble;
+                            }
+                            else
+                            {
+                              readSuccess = false;
+                            }
+                          }
+                          break;
+                        default:
+                          {
+                            readSuccess = false;
+                          }
+                          break;
+                      }
+
+                      if(!readSuccess)
+                      {
+                        error = "Invalid value for option " + cols[0] + ": " + cols[1];
+                      }
+                    }
+                    else
+                    {
+                      readSuccess = false;
+                      error = "Unrecognized option " + cols[0];
+                    }
+                  }
+                  else if(cols.size() == 4)
+                  {
+                    auto optionIt = m_optionsFlags.find(cols[0].toUpper().toStdString());
+
+                    //PRUNE_THRESHOLD <objective> <algorithm> <threshold>. Thresholds are compared with the metrics as
+                    //they are written, so an MAE threshold applies to sqrt(sum|o - s| / n) like the MAE outputs.
+                    if(optionIt != m_optionsFlags.cend() && optionIt->second == 11)
+                    {
+                      PruneThreshold pruneThreshold;
+
+                      if(!tryParseAlgorithm(cols[2], pruneThreshold.algorithm) ||
+                         (pruneThreshold.algorithm != NashSutcliff && pruneThreshold.algorithm != RMSE && pruneThreshold.algorithm != MAE))
+                      {
+                        readSuccess = false;
+                        error = "PRUNE_THRESHOLD only supports the NASH_SUTCLIFF, RMSE and MAE algorithms: " + cols[2];
+                      }
+                      else
+                      {
+                        pruneThreshold.objective = -1;
+                        pruneThreshold.threshold = cols[3].toDouble(&readSuccess);
+
+                        if(readSuccess)
+                        {
+                          pruneObjectives.push_back(cols[1].toStdString());
+                          m_pruneThresholds.push_back(pruneThreshold);
+                        }
+                        else
+                        {
+                          error = "Invalid value for option " + cols[0] + ": " + cols[3];
+                        }
+                      }
+                    }
+                    else
+                    {
+                      readSuccess = false;
+                      error = "Unrecognized option " + cols[0];
+                    }
+                  }
                 }
                 break;
               case 2:
@@ -386,50 +870,46 @@ bool TSObjectiveFunctionComponent::initializeInputFilesArguments(QString &messag
 
                     if(tsFile.exists())
                     {
-                      TimeSeries *timeSeriesObj = nullptr;
+                      addSourceFile(tsFile);
 
-                      if((timeSeriesObj = TimeSeries::createTimeSeries(cols[0],tsFile, this)))
-                      {
-                        QString alg = cols[1];
+                      //Multiple algorithms for the same objective are separated by '|', e.g., NASH_SUTCLIFF|RMSE|KGE
+                      QStringList algs = cols[1].split("|", QString::SkipEmptyParts);
+                      std::vector<Algorithm> algorithms;
 
+                      for(const QString &alg : algs)
+                      {
                         Algorithm algorithm;
 
-                        if(!alg.compare("NASH_SUTCLIFF", Qt::CaseInsensitive))
-                        {
-                          algorithm = Algorithm::NashSutcliff;
-                        }
-                        else if(!alg.compare("RMSE", Qt::CaseInsensitive))
-                        {
-                          algorithm = Algorithm::RMSE;
-                        }
-                        else if(!alg.compare("MAE", Qt::CaseInsensitive))
-                        {
-                          algorithm = Algorithm::MAE;
-                        }
-                        else
+                        if(!tryParseAlgorithm(alg, algorithm))
                         {
-                          message = "Wrong algorithm specification";
+                          message = "Wrong algorithm specification: " + alg;
                           return false;
                         }
 
-                        m_objectiveNames.push_back(cols[0].toStdString());
-                        m_algorithms.push_back(algorithm);
-                        m_inputTSFiles.push_back(timeSeriesObj);
-
-                        if(cols.size() == 4)
-                        {
-                          m_objectiveDesc.push_back(cols[3].toStdString());
-                        }
-                        else
+                        if(std::find(algorithms.begin(), algorithms.end(), algorithm) == algorithms.end())
                         {
-                          m_objectiveDesc.push_back(cols[0].toStdString());
+                          algorithms.push_back(algorithm);
                         }
                       }
-                      else
+
+                      if(algorithms.empty())
                       {
-                        message = "Unable to read ts file";
+                        message = "Wrong algorithm specification";
                         return false;
                       }
+
+                      m_objectiveNames.push_back(cols[0].toStdString());
+                      m_algorithms.push_back(algorithms);
+                      observationFiles.push_back(tsFile);
+
+                      if(cols.size() == 4)
+                      {
+                        m_objectiveDesc.push_back(cols[3].toStdString());
+                      }
+                      else
+                      {
+                        m_objectiveDesc.push_back(cols[0].toStdString());
+                      }
                     }
                     else
                     {
@@ -450,43 +930,47 @@ bool TSObjectiveFunctionComponent::initializeInputFilesArguments(QString &messag
                     QString name = cols[0];
                     QString gtype = cols[1];
                     QString gsource = cols[2];
-                    QList<HCGeometry*> geometries;
+                    QSharedPointer<GeometrySet> geometrySet;
 
+                    //Geometries are shared with other components that read the same source.
                     if(!gtype.compare("SHAPEFILE", Qt::CaseInsensitive))
                     {
                       QFileInfo path = getAbsoluteFilePath(gsource);
-                      Envelope envp;
+                      addSourceFile(path);
+                      geometrySet = GeometryStore::shapefileGeometries(path, error);
 
-                      if(!GeometryFactory::readGeometryFromFile(path.absoluteFilePath(), geometries, envp, error))
+                      if(geometrySet.isNull())
                       {
+                        message = "Line " + QString::number(lineCount) + " : " + error;
                         return false;
                       }
                     }
                     else if (!gtype.compare("WKT", Qt::CaseInsensitive))
                     {
-                      HCGeometry *geometry = GeometryFactory::importFromWkt(gsource);
+                      geometrySet = GeometryStore::wktGeometries(gsource, error);
 
-                      if(!geometry)
+                      if(geometrySet.isNull())
                       {
+                        message = "Line " + QString::number(lineCount) + " : " + error;
                         return false;
                       }
-
-                      geometries.push_back(geometry);
                     }
 
-                    QList<QSharedPointer<HCGeometry>> sharedGeoms;
-
-                    for(HCGeometry *geometry : geometries)
+                    if(geometrySet.isNull())
                     {
-                      sharedGeoms.push_back(QSharedPointer<HCGeometry>(geometry));
+                      m_geometries[name.toStdString()] = QList<QSharedPointer<HCGeometry>>();
+                    }
+                    else
+                    {
+                      m_geometrySets.push_back(geometrySet);
+                      m_geometries[name.toStdString()] = geometrySet->geometries();
                     }
-
-                    m_geometries[name.toStdString()] = sharedGeoms;
 
                   }
                   else
                   {
                     error = "Expected 3 arguments";
+                    message = "Line " + QString::number(lineCount) + " : " + error;
                     return false;
                   }
 
@@ -514,43 +998,60 @@ bool TSObjectiveFunctionComponent::initializeInputFilesArguments(QString &messag
     return false;
   }
 
-  QString outputCSVFile = (*m_inputFilesArgument)["Output CSV File"];
-  m_outputCSVFile = getAbsoluteFilePath(outputCSVFile);
-  outputCSVFile = m_outputCSVFile.absoluteFilePath();
-
-  if (!outputCSVFile.isEmpty() && !outputCSVFile.isNull() && !m_outputCSVFile.absoluteDir().exists())
+  //Observations are loaded once all options are known, since OBSERVATION_CACHE may follow [OBJECTIVES].
+  for(const QFileInfo &observationFile : observationFiles)
   {
-    message = "Output shapefile directory does not exist: " + outputCSVFile;
-    return false;
+    QString timeSeriesKey;
+    QSharedPointer<ObservationSeries> timeSeriesObj = ObservationStore::timeSeries(observationFile, timeSeriesKey, m_observationCache);
+
+    if(timeSeriesObj.isNull())
+    {
+      message = "Unable to read ts file: " + observationFile.absoluteFilePath();
+      return false;
+    }
+
+    m_inputTSFiles.push_back(timeSeriesObj);
+    m_inputTSKeys.push_back(timeSeriesKey.toStdString());
   }
 
-  if (!outputCSVFile.isEmpty() && !outputCSVFile.isNull())
+  //Objectives may be listed after the options that refer to them.
+  for(size_t i = 0; i < m_pruneThresholds.size(); i++)
   {
-    if(m_outputCSVFile.isDir())
-      return true;
+    auto objectiveIt = std::find(m_objectiveNames.begin(), m_objectiveNames.end(), pruneObjectives[i]);
 
-    if (m_outputCSVStream.device() == nullptr)
+    if(objectiveIt == m_objectiveNames.end())
     {
-      QFile *device = new QFile(outputCSVFile, this);
-      m_outputCSVStream.setDevice(device);
+      message = "PRUNE_THRESHOLD refers to an undefined objective: " + QString::fromStdString(pruneObjectives[i]);
+      return false;
     }
 
-    if (m_outputCSVStream.device()->open(QIODevice::WriteOnly | QIODevice::Truncate))
-    {
-      m_outputCSVStream.setRealNumberPrecision(10);
-      m_outputCSVStream.setRealNumberNotation(QTextStream::SmartNotation);
-    }
+    m_pruneThresholds[i].objective = static_cast<int>(objectiveIt - m_objectiveNames.begin());
   }
 
-  if(m_startDate > m_endDate)
+  return true;
+}
+
+bool TSObjectiveFunctionComponent::sourcesUnchanged(const QFileInfo &inputFile) const
+{
+  if(m_sourceFiles.empty() || m_sourceFiles.front().first != inputFile.absoluteFilePath())
     return false;
 
-  timeHorizonInternal()->setJulianDay(m_startDate);
-  timeHorizonInternal()->setDuration(m_endDate - m_startDate);
+  for(const std::pair<QString, qint64> &sourceFile : m_sourceFiles)
+  {
+    QFileInfo file(sourceFile.first);
+
+    if(!file.exists() || file.lastModified().toMSecsSinceEpoch() != sourceFile.second)
+      return false;
+  }
 
   return true;
 }
 
+void TSObjectiveFunctionComponent::addSourceFile(const QFileInfo &file)
+{
+  m_sourceFiles.push_back(std::make_pair(file.absoluteFilePath(), file.lastModified().toMSecsSinceEpoch()));
+}
+
 void TSObjectiveFunctionComponent::createInputs()
 {
   for(size_t i = 0; i < m_objectiveNames.size() ; i++)
@@ -559,15 +1060,41 @@ void TSObjectiveFunctionComponent::createInputs()
     QList<QSharedPointer<HCGeometry>> geometries = m_geometries[name.toStdString()];
     Quantity *quantity = Quantity::unitLessValues("Unitless", QVariant::Double, this);
 
-    ObjectiveInput *objectiveInput = new ObjectiveInput(name, m_inputTSFiles[i], m_timeDimension, m_geometryDimension, geometries[0]->geometryType(), quantity, this);
+    ObjectiveInput *objectiveInput = new ObjectiveInput(name, m_inputTSFiles[i].data(), m_timeDimension, m_geometryDimension, geometries[0]->geometryType(), quantity, this);
     objectiveInput->addGeometries(geometries);
     objectiveInput->setCaption(QString::fromStdString(m_objectiveDesc[i]));
     objectiveInput->setDescription(QString::fromStdString(m_objectiveDesc[i]));
+    objectiveInput->setRetainHistory(m_retainHistory);
+    objectiveInput->setTimeTolerance(m_timeTolerance);
+    objectiveInput->setBatchUpdate(m_batchUpdate);
+    objectiveInput->setTimeSeriesKey(QString::fromStdString(m_inputTSKeys[i]));
+    objectiveInput->setStatisticsKernel(m_statisticsKernel);
+    objectiveInput->setAccumulateLogarithmicStatistics(std::find(m_algorithms[i].begin(), m_algorithms[i].end(), LogNashSutcliff) != m_algorithms[i].end());
     objectiveInput->initialize();
 
+    for(const PruneThreshold &pruneThreshold : m_pruneThresholds)
+    {
+      if(pruneThreshold.objective == static_cast<int>(i) && pruneThreshold.algorithm == NashSutcliff)
+      {
+        objectiveInput->initializeMetricBounds();
+        break;
+      }
+    }
+
     m_objectiveInputs.push_back(objectiveInput);
     addInput(objectiveInput);
   }
+
+  m_updateOrder.resize(m_objectiveInputs.size());
+
+  for(size_t i = 0; i < m_updateOrder.size(); i++)
+  {
+    m_updateOrder[i] = static_cast<int>(i);
+  }
+
+  m_updatedProviders.reserve(m_objectiveInputs.size());
+
+  sortUpdateOrder();
 }
 
 void TSObjectiveFunctionComponent::createOutputs()
@@ -579,82 +1106,505 @@ void TSObjectiveFunctionComponent::createOutputs()
     QString name = QString::fromStdString(m_objectiveNames[i]);
     QList<QSharedPointer<HCGeometry>> geometries = m_geometries[name.toStdString()];
 
-    ObjectiveOutput *objectiveOutput = new ObjectiveOutput(objectiveInput->id(), m_algorithms[i], objectiveInput, this);
-    objectiveOutput->addGeometries(geometries);
-    objectiveOutput->setCaption(QString::fromStdString(m_objectiveDesc[i]));
-    objectiveOutput->setDescription(QString::fromStdString(m_objectiveDesc[i]));
-    m_objectiveOutputs.push_back(objectiveOutput);
-    addOutput(objectiveOutput);
+    const std::vector<Algorithm> &algorithms = m_algorithms[i];
+
+    //All metrics of an objective are derived from the same statistics accumulated by its input.
+    for(Algorithm algorithm : algorithms)
+    {
+      QString id = objectiveInput->id();
+      QString caption = QString::fromStdString(m_objectiveDesc[i]);
+
+      if(algorithms.size() > 1)
+      {
+        id += "_" + algorithmName(algorithm);
+        caption += " (" + algorithmName(algorithm) + ")";
+      }
+
+      ObjectiveOutput *objectiveOutput = new ObjectiveOutput(id, algorithm, objectiveInput, this);
+      objectiveOutput->addGeometries(geometries);
+      objectiveOutput->setCaption(caption);
+      objectiveOutput->setDescription(caption);
+      m_objectiveOutputs.push_back(objectiveOutput);
+      addOutput(objectiveOutput);
+    }
+  }
+
+  openResultWriters();
+}
+
+void TSObjectiveFunctionComponent::openResultWriters()
+{
+  m_resultWriters.clear();
+
+  int mpiProcessRank, mpiProcessCount;
+  mpiRank(mpiProcessRank, mpiProcessCount);
+
+  //Objectives combined across ranks are written by rank 0 only.
+  bool writesOutput = m_distributedMode == Local || mpiProcessRank == 0;
+
+  if(!writesOutput || m_outputFiles.empty())
+    return;
+
+  ResultLayout layout;
+
+  //Only requested algorithms get a metric slot, so blocks are not padded for metrics no objective computes.
+  std::vector<Algorithm> metrics;
+
+  for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+  {
+    metrics.push_back(objectiveOutput->algorithm());
+  }
+
+  std::sort(metrics.begin(), metrics.end());
+  metrics.erase(std::unique(metrics.begin(), metrics.end()), metrics.end());
+
+  for(Algorithm algorithm : metrics)
+  {
+    layout.metrics.append(algorithmName(algorithm));
+  }
+
+  for(ObjectiveInput *objectiveInput : m_objectiveInputs)
+  {
+    layout.objectives.append(objectiveInput->id());
+  }
+
+  for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+  {
+    ResultLayout::Column column;
+    column.id = objectiveOutput->id();
+    column.objective = static_cast<int>(std::find(m_objectiveInputs.begin(), m_objectiveInputs.end(), objectiveOutput->objectiveInput()) - m_objectiveInputs.begin());
+    column.metric = static_cast<int>(std::lower_bound(metrics.begin(), metrics.end(), objectiveOutput->algorithm()) - metrics.begin());
+    column.geometryCount = objectiveOutput->geometryCount();
+    layout.columns.push_back(column);
+  }
+
+  for(const auto &outputFile : m_outputFiles)
+  {
+    QString error;
+    QSharedPointer<ResultWriter> resultWriter = ResultWriter::open(outputFile.first.absoluteFilePath(), outputFile.second, layout, error);
+
+    if(resultWriter)
+    {
+      m_resultWriters.push_back(resultWriter);
+    }
   }
 }
 
 double TSObjectiveFunctionComponent::getMinDate() const
 {
-  double minDate = std::numeric_limits<double>::max();
+  if(m_updateOrder.size())
+  {
+    return m_objectiveInputs[m_updateOrder.front()]->currentDateTime();
+  }
 
-  for(size_t i = 0; i < m_objectiveInputs.size(); i++)
+  return std::numeric_limits<double>::max();
+}
+
+bool TSObjectiveFunctionComponent::evaluateObjectives()
+{
+  if(m_distributedMode == DecomposedDomain)
   {
-    ObjectiveInput *objectiveInput = m_objectiveInputs[i];
-    minDate = std::min(minDate, objectiveInput->currentDateTime());
+    bool reduced = true;
+
+    //Every input is reduced even after a failure, since the reduction is a collective call.
+    for(ObjectiveInput *objectiveInput : m_objectiveInputs)
+    {
+      reduced = objectiveInput->reduceStatistics() && reduced;
+    }
+
+    if(!reduced)
+      return false;
   }
 
-  return minDate;
+  int numOutputs = static_cast<int>(m_objectiveOutputs.size());
+
+#ifdef USE_OPENMP
+  int numGeometries = 0;
+
+  for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+  {
+    numGeometries += objectiveOutput->geometryCount();
+  }
+
+  //Many small objectives are spread across threads. A single large objective parallelizes over its own
+  //geometries instead. Each output writes only its own values, so the results do not depend on the number of threads.
+#pragma omp parallel for schedule(dynamic) if(numOutputs > 1 && numGeometries >= ObjectiveStatisticsArray::parallelThreshold())
+#endif
+  for(int i = 0; i < numOutputs; i++)
+  {
+    m_objectiveOutputs[i]->evaluate();
+  }
+
+  return true;
 }
 
-void TSObjectiveFunctionComponent::writeOutput()
+bool TSObjectiveFunctionComponent::pruneThresholdExceeded(QString &message) const
 {
-  if (m_outputCSVStream.device() && m_outputCSVStream.device()->isOpen())
+  //Ranks of a decomposed domain reduce their statistics at the end of the horizon in a collective call, so
+  //they are never stopped early. Ensemble members only meet when the parent finishes and are pruned on their own.
+  if(m_distributedMode == DecomposedDomain)
+    return false;
+
+  for(const PruneThreshold &pruneThreshold : m_pruneThresholds)
   {
-    if(m_objectiveInputs.size())
+    ObjectiveInput *objectiveInput = m_objectiveInputs[pruneThreshold.objective];
+    double bound = objectiveInput->metricLowerBound(pruneThreshold.algorithm);
+
+    if(bound > pruneThreshold.threshold)
     {
-      ObjectiveInput *objectiveInput = m_objectiveInputs[0];
+      message = "Objective: " + objectiveInput->id() + " | Algorithm: " + algorithmName(pruneThreshold.algorithm) +
+                " | Lower bound: " + QString::number(bound) + " | Threshold: " + QString::number(pruneThreshold.threshold);
+      return true;
+    }
+  }
 
-      m_outputCSVStream << objectiveInput->id();
+  return false;
+}
 
-      for(int j = 1; j < objectiveInput->geometryCount() ; j++)
-      {
-        m_outputCSVStream <<  ", " << objectiveInput->id();
-      }
+void TSObjectiveFunctionComponent::sortUpdateOrder()
+{
+  //Inputs advance by one observation per step, so the order is nearly sorted and an in place
+  //insertion sort restores it in close to linear time without allocating.
+  for(size_t i = 1; i < m_updateOrder.size(); i++)
+  {
+    int index = m_updateOrder[i];
+    double dateTime = m_objectiveInputs[index]->currentDateTime();
+    size_t j = i;
 
-      for(size_t i = 1; i < m_objectiveInputs.size(); i++)
-      {
-        objectiveInput = m_objectiveInputs[i];
+    while (j > 0 && m_objectiveInputs[m_updateOrder[j - 1]]->currentDateTime() > dateTime)
+    {
+      m_updateOrder[j] = m_updateOrder[j - 1];
+      j--;
+    }
 
-        for(int j = 0; j < objectiveInput->geometryCount() ; j++)
-        {
-          m_outputCSVStream <<  ", " << objectiveInput->id();
-        }
-      }
+    m_updateOrder[j] = index;
+  }
+}
 
-      m_outputCSVStream << endl;
+void TSObjectiveFunctionComponent::writeOutput()
+{
+  ResultRow row;
+  row.runId = runId();
+  row.iteration = m_iteration++;
+  row.snapshot = false;
+  row.dateTime = std::numeric_limits<double>::quiet_NaN();
 
-      ObjectiveOutput *objectiveOutput = m_objectiveOutputs[0];
+  for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+  {
+    for(int j = 0; j < objectiveOutput->geometryCount() ; j++)
+    {
       double value = 0;
+      objectiveOutput->getValue(j,&value);
+      row.values.push_back(value);
+    }
+  }
+
+  writeResultRow(row);
+}
+
+void TSObjectiveFunctionComponent::writeSnapshot(double dateTime)
+{
+  //Snapshots are taken from the running statistics of this process, which only hold complete objectives when
+  //objectives are not reduced across ranks.
+  if(m_distributedMode != DecomposedDomain)
+  {
+    ResultRow row;
+    row.runId = runId();
+    row.iteration = m_iteration;
+    row.snapshot = true;
+    row.dateTime = dateTime;
+
+    for(ObjectiveOutput *objectiveOutput : m_objectiveOutputs)
+    {
+      size_t offset = row.values.size();
+      row.values.resize(offset + objectiveOutput->geometryCount());
+      objectiveOutput->objectiveInput()->metrics(objectiveOutput->algorithm(), row.values.data() + offset);
+    }
+
+    writeResultRow(row);
+  }
+
+  while (m_nextSnapshotTime <= dateTime)
+  {
+    m_nextSnapshotTime += m_snapshotInterval;
+  }
+}
 
-      objectiveOutput->getValue(0,&value);
-      m_outputCSVStream << value;
+void TSObjectiveFunctionComponent::writeResultRow(ResultRow &row)
+{
+  int mpiProcessRank, mpiProcessCount;
+
+  if(m_distributedMode == Ensemble && mpiRank(mpiProcessRank, mpiProcessCount) && mpiProcessCount > 1)
+  {
+    row.runId += "_rank_" + QString::number(mpiProcessRank);
+
+    TSObjectiveFunctionComponent *rootComponent = this;
 
-      for(int j = 1; j < objectiveOutput->geometryCount() ; j++)
+    while (rootComponent->m_parent)
+    {
+      rootComponent = rootComponent->m_parent;
+    }
+
+    //Members on a rank share the parent's buffer and MPI calls are made by one thread at a time.
+#ifdef USE_OPENMP
+#pragma omp critical (TSObjectiveFunctionComponent)
+#endif
+    {
+      if(mpiProcessRank == 0)
       {
-        objectiveOutput->getValue(j,&value);
-        m_outputCSVStream <<  ", " << value;
+        rootComponent->receiveEnsembleRows(false);
       }
-
-      for(size_t i = 1; i < m_objectiveOutputs.size(); i++)
+      else
       {
-        objectiveOutput = m_objectiveOutputs[i];
+        rootComponent->m_ensembleRows.push_back(row);
 
-        for(int j = 0; j < objectiveOutput->geometryCount() ; j++)
+        if(static_cast<int>(rootComponent->m_ensembleRows.size()) >= m_ensembleBatchSize)
         {
-          objectiveOutput->getValue(j,&value);
-          m_outputCSVStream <<  ", " << value;
+          rootComponent->sendEnsembleRows();
         }
       }
+    }
+
+    if(mpiProcessRank != 0)
+      return;
+  }
+
+  queueResultRow(row);
+}
+
+void TSObjectiveFunctionComponent::queueResultRow(const ResultRow &row)
+{
+  for(const QSharedPointer<ResultWriter> &resultWriter : m_resultWriters)
+  {
+    if(row.snapshot)
+    {
+      resultWriter->writeSnapshot(row.runId, row.iteration, row.dateTime, row.values);
+    }
+    else
+    {
+      resultWriter->write(row.runId, row.iteration, row.values);
+    }
+  }
+}
+
+void TSObjectiveFunctionComponent::sendEnsembleRows()
+{
+#ifdef USE_MPI
+  if(m_ensembleRows.empty())
+    return;
+
+  //Rows are packed as kind, iteration, date time, value count and values.
+  std::vector<double> rowValues;
+  QByteArray runIds;
 
-      m_outputCSVStream << endl;
-      m_outputCSVStream.flush();
+  for(const ResultRow &row : m_ensembleRows)
+  {
+    rowValues.push_back(row.snapshot ? 1.0 : 0.0);
+    rowValues.push_back(row.iteration);
+    rowValues.push_back(row.dateTime);
+    rowValues.push_back(static_cast<double>(row.values.size()));
+    rowValues.insert(rowValues.end(), row.values.begin(), row.values.end());
+    runIds.append(row.runId.toUtf8());
+    runIds.append('\n');
+  }
+
+  m_ensembleRows.clear();
+
+  MPI_Send(rowValues.data(), static_cast<int>(rowValues.size()), MPI_DOUBLE, 0, ensembleValuesTag, MPI_COMM_WORLD);
+  MPI_Send(runIds.data(), runIds.size(), MPI_CHAR, 0, ensembleRunIdsTag, MPI_COMM_WORLD);
+#endif
+}
+
+void TSObjectiveFunctionComponent::receiveEnsembleRows(bool waitForRanks)
+{
+#ifdef USE_MPI
+  int mpiProcessRank, mpiProcessCount;
+  mpiRank(mpiProcessRank, mpiProcessCount);
+
+  while (!waitForRanks || m_finishedEnsembleRanks < mpiProcessCount - 1)
+  {
+    MPI_Status status;
+
+    if(waitForRanks)
+    {
+      MPI_Probe(MPI_ANY_SOURCE, ensembleValuesTag, MPI_COMM_WORLD, &status);
+    }
+    else
+    {
+      int available = 0;
+      MPI_Iprobe(MPI_ANY_SOURCE, ensembleValuesTag, MPI_COMM_WORLD, &available, &status);
+
+      if(!available)
+        break;
     }
+
+    int valueCount = 0;
+    MPI_Get_count(&status, MPI_DOUBLE, &valueCount);
+
+    std::vector<double> rowValues(valueCount);
+    MPI_Recv(rowValues.data(), valueCount, MPI_DOUBLE, status.MPI_SOURCE, ensembleValuesTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    //An empty message marks the end of the rows of a rank, which may arrive while rank 0 still runs members.
+    if(valueCount == 0)
+    {
+      m_finishedEnsembleRanks++;
+      continue;
+    }
+
+    MPI_Status runIdStatus;
+    MPI_Probe(status.MPI_SOURCE, ensembleRunIdsTag, MPI_COMM_WORLD, &runIdStatus);
+
+    int runIdCount = 0;
+    MPI_Get_count(&runIdStatus, MPI_CHAR, &runIdCount);
+
+    QByteArray runIds(runIdCount, '\0');
+    MPI_Recv(runIds.data(), runIdCount, MPI_CHAR, status.MPI_SOURCE, ensembleRunIdsTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+    QList<QByteArray> rowRunIds = runIds.split('\n');
+    size_t offset = 0;
+
+    for(int k = 0; k < rowRunIds.size() - 1; k++)
+    {
+      ResultRow row;
+      row.runId = QString::fromUtf8(rowRunIds[k]);
+      row.snapshot = rowValues[offset] != 0.0;
+      row.iteration = static_cast<int>(rowValues[offset + 1]);
+      row.dateTime = rowValues[offset + 2];
+
+      size_t count = static_cast<size_t>(rowValues[offset + 3]);
+      row.values.assign(rowValues.begin() + offset + 4, rowValues.begin() + offset + 4 + count);
+      offset += 4 + count;
+
+      queueResultRow(row);
+    }
+  }
+#else
+  Q_UNUSED(waitForRanks)
+#endif
+}
+
+void TSObjectiveFunctionComponent::finishEnsembleRows()
+{
+#ifdef USE_MPI
+  int mpiProcessRank, mpiProcessCount;
+
+  if(!mpiRank(mpiProcessRank, mpiProcessCount) || mpiProcessCount < 2)
+    return;
+
+  if(mpiProcessRank == 0)
+  {
+    receiveEnsembleRows(true);
+    m_finishedEnsembleRanks = 0;
+  }
+  else
+  {
+    sendEnsembleRows();
+    MPI_Send(nullptr, 0, MPI_DOUBLE, 0, ensembleValuesTag, MPI_COMM_WORLD);
+  }
+#endif
+}
+
+QString TSObjectiveFunctionComponent::runId() const
+{
+  return m_runId.isEmpty() ? id() : m_runId;
+}
+
+bool TSObjectiveFunctionComponent::retainHistory() const
+{
+  return m_retainHistory;
+}
+
+bool TSObjectiveFunctionComponent::isPruned() const
+{
+  return m_pruned;
+}
+
+bool TSObjectiveFunctionComponent::runningOutputsDue() const
+{
+  //Statistics of decomposed domains are only complete once they are reduced at the end of the horizon.
+  return m_runningOutputSteps > 0 && m_stepCount > 0 && m_stepCount % m_runningOutputSteps == 0 &&
+      m_distributedMode != DecomposedDomain;
+}
+
+bool TSObjectiveFunctionComponent::tryParseAlgorithm(const QString &name, Algorithm &algorithm)
+{
+  if(!name.compare("NASH_SUTCLIFF", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::NashSutcliff;
+  }
+  else if(!name.compare("RMSE", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::RMSE;
+  }
+  else if(!name.compare("MAE", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::MAE;
+  }
+  else if(!name.compare("KGE", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::KlingGupta;
+  }
+  else if(!name.compare("PBIAS", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::PercentBias;
+  }
+  else if(!name.compare("LOG_NASH_SUTCLIFF", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::LogNashSutcliff;
+  }
+  else if(!name.compare("R2", Qt::CaseInsensitive))
+  {
+    algorithm = Algorithm::RSquared;
+  }
+  else
+  {
+    return false;
   }
+
+  return true;
+}
+
+QString TSObjectiveFunctionComponent::algorithmName(Algorithm algorithm)
+{
+  switch (algorithm)
+  {
+    case Algorithm::NashSutcliff:
+      return "NASH_SUTCLIFF";
+    case Algorithm::RMSE:
+      return "RMSE";
+    case Algorithm::MAE:
+      return "MAE";
+    case Algorithm::KlingGupta:
+      return "KGE";
+    case Algorithm::PercentBias:
+      return "PBIAS";
+    case Algorithm::LogNashSutcliff:
+      return "LOG_NASH_SUTCLIFF";
+    case Algorithm::RSquared:
+      return "R2";
+  }
+
+  return QString();
+}
+
+bool TSObjectiveFunctionComponent::readBoolean(const QString &value, bool &result)
+{
+  if(!value.compare("TRUE", Qt::CaseInsensitive) ||
+     !value.compare("YES", Qt::CaseInsensitive) ||
+     !value.compare("1", Qt::CaseInsensitive))
+  {
+    result = true;
+    return true;
+  }
+  else if(!value.compare("FALSE", Qt::CaseInsensitive) ||
+          !value.compare("NO", Qt::CaseInsensitive) ||
+          !value.compare("0", Qt::CaseInsensitive))
+  {
+    result = false;
+    return true;
+  }
+
+  return false;
 }
 
 const unordered_map<string, int> TSObjectiveFunctionComponent::m_inputFileFlags({
@@ -666,6 +1616,20 @@ const unordered_map<string, int> TSObjectiveFunctionComponent::m_inputFileFlags(
 const unordered_map<string, int> TSObjectiveFunctionComponent::m_optionsFlags({
                                                                                 {"START_DATETIME", 1},
                                                                                 {"END_DATETIME", 2},
+                                                                                {"RETAIN_HISTORY", 3},
+                                                                                {"STATISTICS_KERNEL", 4},
+                                                                                {"TIME_TOLERANCE", 5},
+                                                                                {"OBSERVATION_CACHE", 6},
+                                                                                {"BATCH_UPDATE", 7},
+                                                                                {"MPI_MODE", 8},
+                                                                                {"CLONE_POOL", 9},
+                                                                                {"OUTPUT_SNAPSHOT_INTERVAL", 10},
+                                                                                {"PRUNE_THRESHOLD", 11},
+                                                                                {"RUNNING_OUTPUT_STEPS", 12},
                                                                               });
 
+const double TSObjectiveFunctionComponent::m_defaultTimeTolerance = 0.5 / 86400.0;
+
 const QRegExp TSObjectiveFunctionComponent::m_dateTimeDelim("(\\,|\\t|\\\n|\\/|\\s+|\\:)");
+
+const int TSObjectiveFunctionComponent::m_ensembleBatchSize = 64;